@@ -0,0 +1,215 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : allocator_bench.cpp
+*  System name   : jack_module
+*
+*  Description   : buffer allocator benchmark
+*		   TLB misses, page faults and per-period latency of a
+*		    large ringbuffer for each kind of allocation
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "ringbuffer.h"
+
+/*
+ * Usage: allocator_bench [outputfile.json]
+ *
+ * Without an argument the JSON result goes to stdout.
+ *
+ * Like onProcess() with CHANNELS channels, every period pushes one JACK
+ *  period of interleaved audio into a ringbuffer of SECONDS seconds and
+ *  pops one period, PASSES times around the ringbuffer. The first pass
+ *  is reported separately as that's where the page faults happen
+ *  without PREFAULT.
+ *
+ * TLB misses and page faults come from perf_event_open(). Where that's
+ *  not permitted (see /proc/sys/kernel/perf_event_paranoid) they are
+ *  reported as null.
+ */
+
+#define CHANNELS 64
+#define PERIOD 256
+#define SAMPLERATE 48000
+#define SECONDS 4
+#define PASSES 4
+
+typedef std::chrono::steady_clock benchclock;
+
+
+static int openCounter(unsigned int type,unsigned long config)
+{
+struct perf_event_attr attr;
+
+  memset(&attr,0,sizeof(attr));
+  attr.size=sizeof(attr);
+  attr.type=type;
+  attr.config=config;
+  attr.disabled=1;
+  attr.exclude_hv=1;
+  return syscall(SYS_perf_event_open,&attr,0,-1,-1,0);
+} // openCounter()
+
+
+/*
+ * Counters of the TLB misses and page faults of this thread
+ */
+class Counters
+{
+public:
+  Counters()
+  {
+    tlb=openCounter(PERF_TYPE_HW_CACHE,PERF_COUNT_HW_CACHE_DTLB |
+      (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    faults=openCounter(PERF_TYPE_SOFTWARE,PERF_COUNT_SW_PAGE_FAULTS);
+  }
+  ~Counters()
+  {
+    if(tlb >= 0) close(tlb);
+    if(faults >= 0) close(faults);
+  }
+  void start()
+  {
+    for(int fd : {tlb,faults}){
+      if(fd < 0) continue;
+      ioctl(fd,PERF_EVENT_IOC_RESET,0);
+      ioctl(fd,PERF_EVENT_IOC_ENABLE,0);
+    }
+  }
+  void stop(std::ostream &out,const char *name)
+  {
+    out << "\"" << name << "\": {";
+    print(out,"dtlb_load_misses",tlb);
+    out << ", ";
+    print(out,"page_faults",faults);
+    out << "}";
+  }
+private:
+  void print(std::ostream &out,const char *name,int fd)
+  {
+    long long count;
+    out << "\"" << name << "\": ";
+    if(fd >= 0 && ioctl(fd,PERF_EVENT_IOC_DISABLE,0) == 0 &&
+       read(fd,&count,sizeof(count)) == sizeof(count)) out << count;
+    else out << "null";
+  }
+  int tlb,faults;
+}; // Counters{}
+
+
+static double percentile(std::vector<double> &sorted,double p)
+{
+  return sorted[(unsigned long)(p*(sorted.size()-1))];
+} // percentile()
+
+
+static void printLatency(std::ostream &out,const char *name,std::vector<double> latency)
+{
+  std::sort(latency.begin(),latency.end());
+  out << "\"" << name << "\": {"
+      << "\"p50\": " << percentile(latency,0.5)
+      << ", \"p99\": " << percentile(latency,0.99)
+      << ", \"max\": " << latency.back()
+      << "}";
+} // printLatency()
+
+
+static void runConfig(std::ostream &out,const char *name,BufferAllocator *allocator,bool first)
+{
+unsigned long size=CHANNELS*SAMPLERATE*SECONDS;
+unsigned long chunk=CHANNELS*PERIOD;
+unsigned long periods=size/chunk;
+std::vector<float> data(chunk,0.5);
+std::vector<double> firstpass,later; // usec per period
+Counters firstcounters,latercounters;
+
+  auto setupstart=benchclock::now();
+  RingBuffer *ringbuffer = new RingBuffer(size,name,allocator);
+  double setup=std::chrono::duration<double,std::micro>(benchclock::now()-setupstart).count();
+
+  if(!first) out << ",\n";
+  out << "    {\"allocation\": \"" << name << "\""
+      << ", \"ring_bytes\": " << size*sizeof(float)
+      << ", \"setup_us\": " << setup << ", ";
+
+  for(int pass=0; pass<PASSES; pass++){
+    Counters &counters = pass == 0 ? firstcounters : latercounters;
+    std::vector<double> &latency = pass == 0 ? firstpass : later;
+    if(pass < 2) counters.start();
+    for(unsigned long period=0; period<periods; period++){
+      auto start=benchclock::now();
+      ringbuffer->push(data.data(),chunk);
+      ringbuffer->pop(data.data(),chunk);
+      latency.push_back(std::chrono::duration<double,std::micro>(benchclock::now()-start).count());
+    }
+    if(pass == 0) firstcounters.stop(out,"first_pass_counters");
+    if(pass == 0) out << ", ";
+  }
+  latercounters.stop(out,"later_passes_counters");
+  out << ", ";
+  printLatency(out,"first_pass_period_us",firstpass);
+  out << ", ";
+  printLatency(out,"later_passes_period_us",later);
+  out << "}";
+
+  delete ringbuffer;
+} // runConfig()
+
+
+int main(int argc,char **argv)
+{
+std::ofstream outfile;
+BufferAllocator plain(BufferAllocator::DEFAULT);
+BufferAllocator prefault(BufferAllocator::PREFAULT|BufferAllocator::LOCK);
+BufferAllocator huge(BufferAllocator::HUGEPAGES);
+BufferAllocator hugeprefault(BufferAllocator::HUGEPAGES|BufferAllocator::PREFAULT|BufferAllocator::LOCK);
+
+  if(argc > 1) outfile.open(argv[1]);
+  std::ostream &out = (argc > 1) ? outfile : std::cout;
+
+  out << "{\n  \"benchmark\": \"allocator\",\n";
+  out << "  \"channels\": " << CHANNELS << ", \"period\": " << PERIOD << ",\n";
+  out << "  \"results\": [\n";
+
+  runConfig(out,"new",NULL,true);
+  runConfig(out,"mmap",&plain,false);
+  runConfig(out,"mmap_prefault_lock",&prefault,false);
+  runConfig(out,"hugepages",&huge,false);
+  runConfig(out,"hugepages_prefault_lock",&hugeprefault,false);
+
+  out << "\n  ]\n}\n";
+
+  return 0;
+} // main()
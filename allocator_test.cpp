@@ -0,0 +1,94 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : allocator_test.cpp
+*  System name   : jack_module
+*
+*  Description   : buffer allocator test
+*		   Allocates with every combination of flags and runs a
+*		    ramp through a ringbuffer on allocated memory
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+#include <iostream>
+#include <stdint.h>
+#include <unistd.h>
+#include "buffer_allocator.h"
+#include "ringbuffer.h"
+
+#define BYTES (3UL<<20) // not a multiple of a huge page
+#define RINGSIZE 100000
+#define CHUNKSIZE 256
+
+
+static int testFlags(int flags)
+{
+BufferAllocator allocator(flags);
+int errors=0;
+
+  char *memory=(char *)allocator.allocate(BYTES);
+  uintptr_t alignment = (flags & BufferAllocator::HUGEPAGES) ? HUGEPAGESIZE : sysconf(_SC_PAGESIZE);
+  if((uintptr_t)memory % alignment) errors++;
+  for(unsigned long i=0; i<BYTES; i++){
+    if(memory[i] != 0) errors++;
+    memory[i]=(char)i;
+  }
+  for(unsigned long i=0; i<BYTES; i++){
+    if(memory[i] != (char)i) errors++;
+  }
+  allocator.release(memory,BYTES);
+
+  std::cout << "flags " << flags << ": " << errors << " errors" << std::endl;
+  return errors;
+} // testFlags()
+
+
+int main()
+{
+int errors=0;
+float data[CHUNKSIZE];
+
+  for(int flags=0; flags<8; flags++) errors+=testFlags(flags);
+
+  BufferAllocator allocator(BufferAllocator::HUGEPAGES|BufferAllocator::PREFAULT);
+  RingBuffer ringbuffer(RINGSIZE,"test",&allocator);
+  // several times around the ringbuffer
+  for(unsigned long chunk=0; chunk<5*RINGSIZE/CHUNKSIZE; chunk++){
+    for(unsigned long i=0; i<CHUNKSIZE; i++) data[i]=chunk*CHUNKSIZE+i;
+    ringbuffer.push(data,CHUNKSIZE);
+    ringbuffer.pop(data,CHUNKSIZE);
+    for(unsigned long i=0; i<CHUNKSIZE; i++){
+      if(data[i] != chunk*CHUNKSIZE+i) errors++;
+    }
+  }
+  std::cout << "ringbuffer: " << errors << " errors so far" << std::endl;
+
+  // NUMA may not be available, then there's nothing to check
+  int node=BufferAllocator::currentNumaNode();
+  std::cout << "running on NUMA node " << node << ", moving the ringbuffer there " <<
+    (ringbuffer.moveToNode(node < 0 ? 0 : node) == 0 ? "worked" : "is not supported") << std::endl;
+
+  return errors ? 1 : 0;
+} // main()
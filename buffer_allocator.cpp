@@ -0,0 +1,215 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : buffer_allocator.cpp
+*  System name   : jack_module
+*
+*  Description   : buffer allocator class implementation
+*		   Allocates ringbuffer and scratch memory on huge pages,
+*		    prefaulted, locked and/or on a given NUMA node
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+
+/*
+ * A multi-second ringbuffer for many channels spans thousands of 4K
+ *  pages. The audio callback walks through all of them, so it keeps
+ *  missing the TLB, and the first time it touches a page the kernel has
+ *  to find memory for it: a page fault in the real-time thread.
+ *
+ * With HUGEPAGES the buffer is mapped with 2M pages. Reserved huge pages
+ *  (vm.nr_hugepages) are used if there are any, otherwise the mapping is
+ *  aligned to 2M and marked for transparent huge pages, which the kernel
+ *  may or may not provide. PREFAULT and LOCK make sure all pages exist
+ *  and stay in memory before the callback uses them.
+ *
+ * On a machine with more than one NUMA node, memory on the node of the
+ *  CPU that runs the JACK callback is faster for that callback. The node
+ *  can be given in advance, or pages can be moved afterwards with
+ *  moveToNode(), see JackModule::moveBuffersToJackNode().
+ *
+ * NUMA placement uses the mbind() system call directly, so there's no
+ *  need for libnuma.
+ */
+
+#include <iostream>
+#include <new> // std::bad_alloc
+#include <stdint.h>
+#include <string.h> // memset
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h> // MPOL_*
+#include "buffer_allocator.h"
+
+// highest NUMA node moveToNode() can handle
+#define MAXNUMANODES 1024
+
+
+/*
+ * numanode -1 leaves the placement to the kernel
+ */
+BufferAllocator::BufferAllocator(int flags,int numanode)
+{
+  this->flags=flags;
+  this->numanode=numanode;
+} // BufferAllocator()
+
+
+BufferAllocator::~BufferAllocator()
+{
+} // ~BufferAllocator()
+
+
+/*
+ * Size of the mapping for a buffer of the given size: whole pages, or
+ *  whole huge pages with HUGEPAGES
+ */
+unsigned long BufferAllocator::mappedSize(unsigned long bytes)
+{
+  unsigned long pagesize = (flags & HUGEPAGES) ? HUGEPAGESIZE : sysconf(_SC_PAGESIZE);
+  if(bytes == 0) bytes=1;
+  return (bytes+pagesize-1) & ~(pagesize-1);
+} // mappedSize()
+
+
+/*
+ * Returns page aligned memory, filled with zeros. Throws std::bad_alloc
+ *  if there's no memory. Failing to lock the memory is not an error, as
+ *  the memory can still be used; a message tells what happened.
+ */
+void *BufferAllocator::allocate(unsigned long bytes)
+{
+unsigned long length=mappedSize(bytes);
+void *memory=MAP_FAILED;
+
+  if(flags & HUGEPAGES){
+#ifdef MAP_HUGETLB
+    memory=mmap(NULL,length,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+#endif
+    if(memory == MAP_FAILED){
+      // map one huge page more than needed and trim it to an aligned range
+      char *area=(char *)mmap(NULL,length+HUGEPAGESIZE,PROT_READ|PROT_WRITE,
+                              MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+      if(area != MAP_FAILED){
+        char *aligned=(char *)(((uintptr_t)area+HUGEPAGESIZE-1) & ~(HUGEPAGESIZE-1));
+        unsigned long before=aligned-area;
+        if(before > 0) munmap(area,before);
+        munmap(aligned+length,HUGEPAGESIZE-before);
+        memory=aligned;
+#ifdef MADV_HUGEPAGE
+        madvise(memory,length,MADV_HUGEPAGE);
+#endif
+      }
+    }
+  }
+  else {
+    memory=mmap(NULL,length,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+  }
+  if(memory == MAP_FAILED) throw std::bad_alloc();
+
+  // before the pages exist, so they're created on the right node
+  if(numanode >= 0) moveToNode(memory,length,numanode);
+
+  if(flags & PREFAULT) memset(memory,0,length);
+  if(flags & LOCK){
+    if(mlock(memory,length) != 0) {
+      std::cout << "Cannot lock " << length << " bytes of memory, see ulimit -l" << std::endl;
+    }
+  }
+
+  return memory;
+} // allocate()
+
+
+/*
+ * bytes must be the size given to allocate()
+ */
+void BufferAllocator::release(void *memory,unsigned long bytes)
+{
+  if(memory == NULL) return;
+  munmap(memory,mappedSize(bytes)); // also unlocks
+} // release()
+
+
+int BufferAllocator::getFlags()
+{
+  return flags;
+} // getFlags()
+
+
+int BufferAllocator::getNumaNode()
+{
+  return numanode;
+} // getNumaNode()
+
+
+/*
+ * Node for allocations from now on, -1 for no preference
+ */
+void BufferAllocator::setNumaNode(int numanode)
+{
+  this->numanode=numanode;
+} // setNumaNode()
+
+
+/*
+ * Prefer the given NUMA node for the pages of this memory and move the
+ *  pages that already exist there. Works for any memory of the process;
+ *  the pages at both ends are moved as a whole.
+ *
+ * Returns 0, or -1 if the kernel doesn't support it or the node doesn't
+ *  exist. Not for the audio callback: moving pages takes time.
+ */
+int BufferAllocator::moveToNode(void *memory,unsigned long bytes,int numanode)
+{
+unsigned long nodemask[MAXNUMANODES/(8*sizeof(unsigned long))];
+
+  if(memory == NULL || numanode < 0 || numanode >= MAXNUMANODES) return -1;
+
+  uintptr_t pagesize=sysconf(_SC_PAGESIZE);
+  uintptr_t start=(uintptr_t)memory & ~(pagesize-1);
+  uintptr_t end=((uintptr_t)memory+bytes+pagesize-1) & ~(pagesize-1);
+
+  memset(nodemask,0,sizeof(nodemask));
+  nodemask[numanode/(8*sizeof(unsigned long))] |= 1UL << (numanode%(8*sizeof(unsigned long)));
+
+  // MPOL_PREFERRED falls back to other nodes instead of failing when full
+  if(syscall(SYS_mbind,start,end-start,MPOL_PREFERRED,nodemask,
+             (unsigned long)MAXNUMANODES,MPOL_MF_MOVE) != 0) return -1;
+  return 0;
+} // moveToNode()
+
+
+/*
+ * NUMA node of the CPU the calling thread runs on, or -1
+ */
+int BufferAllocator::currentNumaNode()
+{
+unsigned int cpu,node;
+
+  if(syscall(SYS_getcpu,&cpu,&node,NULL) != 0) return -1;
+  return node;
+} // currentNumaNode()
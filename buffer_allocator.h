@@ -0,0 +1,64 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : buffer_allocator.h
+*  System name   : jack_module
+*
+*  Description   : buffer allocator class description
+*		   Allocates ringbuffer and scratch memory on huge pages,
+*		    prefaulted, locked and/or on a given NUMA node
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+#ifndef BUFFER_ALLOCATOR_H
+#define BUFFER_ALLOCATOR_H
+
+#define HUGEPAGESIZE (2UL<<20)
+
+class BufferAllocator
+{
+public:
+  // flags, combine with |
+  enum {
+    DEFAULT=0,
+    HUGEPAGES=1, // MAP_HUGETLB if available, otherwise transparent huge pages
+    PREFAULT=2, // touch every page now instead of in the audio callback
+    LOCK=4 // mlock(), so the pages can't be swapped out
+  };
+  BufferAllocator(int flags=DEFAULT,int numanode=-1);
+  virtual ~BufferAllocator();
+  virtual void *allocate(unsigned long bytes);
+  virtual void release(void *memory,unsigned long bytes);
+  int getFlags();
+  int getNumaNode();
+  void setNumaNode(int numanode);
+  static int moveToNode(void *memory,unsigned long bytes,int numanode);
+  static int currentNumaNode();
+private:
+  unsigned long mappedSize(unsigned long bytes);
+  int flags;
+  int numanode; // -1: wherever the kernel puts it
+}; // BufferAllocator{}
+
+#endif
@@ -0,0 +1,187 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : history_buffer.cpp
+*  System name   : jack_module
+*
+*  Description   : history buffer class implementation
+*		   Keeps the most recent audio per channel, addressed by
+*		    frame time, with a seqlock for concurrent readers
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+
+/*
+ * The audio callback writes every period into the history, overwriting
+ *  the oldest frames. Any number of other threads may copy out a range
+ *  of frames at any moment, e.g. to get the audio from just before a
+ *  trigger.
+ *
+ * The writer never waits for readers. Instead, readers check afterwards
+ *  whether the writer got to the frames they were copying. The sequence
+ *  number is odd while a write is in progress and endtime tells which
+ *  frames are valid, so a reader knows whether its copy is intact.
+ *
+ * Frame times are JACK frame times, which wrap around at 2^32. All
+ *  comparisons use unsigned differences so the wrap doesn't matter as
+ *  long as the history is shorter than 2^31 frames.
+ */
+
+#include "history_buffer.h"
+#include <string.h> // memcpy
+
+
+/*
+ * The number of frames is rounded up to a power of two, so frame time
+ *  modulo frames stays continuous when the frame time wraps around
+ */
+HistoryBuffer::HistoryBuffer(int channels,unsigned long frames)
+{
+  this->channels=channels;
+  this->frames=1;
+  while(this->frames < frames) this->frames<<=1;
+  frames=this->frames;
+  buffer = new float [channels*frames];
+  memset(buffer,0,channels*frames*sizeof(float));
+  sequence=0;
+  endtime=0;
+  filled=0;
+} // HistoryBuffer()
+
+
+HistoryBuffer::~HistoryBuffer()
+{
+  delete [] buffer;
+} // ~HistoryBuffer()
+
+
+/*
+ * Called by the audio callback: add nframes for every channel, the first
+ *  of which has the given frame time. If they don't follow up on the
+ *  previous write, e.g. after an xrun or a reconnect, the history starts
+ *  over from these frames.
+ */
+void HistoryBuffer::write(float * const *channeldata,unsigned long nframes,uint32_t frametime)
+{
+  // if more than the history comes in, only the last part fits
+  unsigned long skip = nframes > frames ? nframes-frames : 0;
+  unsigned long n=nframes-skip;
+  unsigned long position=(frametime+skip)%frames;
+
+  sequence.fetch_add(1,std::memory_order_relaxed); // odd: busy
+  std::atomic_thread_fence(std::memory_order_release);
+
+  for(int channel=0; channel<channels; channel++){
+    float *history=buffer+channel*frames;
+    const float *source=channeldata[channel]+skip;
+    if(position+n <= frames){
+      memcpy(history+position,source,n*sizeof(float));
+    }
+    else {
+      unsigned long first_chunk=frames-position;
+      memcpy(history+position,source,first_chunk*sizeof(float));
+      memcpy(history,source+first_chunk,(n-first_chunk)*sizeof(float));
+    }
+  }
+
+  // after a gap the frames before it don't belong to this stream of time
+  bool continued = endtime.load(std::memory_order_relaxed) == frametime;
+  unsigned long nowfilled=(continued ? filled.load(std::memory_order_relaxed) : 0)+nframes;
+  endtime.store(frametime+nframes,std::memory_order_relaxed);
+  filled.store(nowfilled < frames ? nowfilled : frames,std::memory_order_relaxed);
+  sequence.fetch_add(1,std::memory_order_release); // even: done
+} // write()
+
+
+/*
+ * Copy the frames [start,end) of one channel into data
+ *
+ * Returns HISTORY_OK or one of the HISTORY_ error codes. With
+ *  HISTORY_OVERWRITTEN the writer reused (part of) the range while it
+ *  was being copied, which only happens for ranges at the very start of
+ *  the history.
+ */
+int HistoryBuffer::read(int channel,uint32_t start,uint32_t end,float *data)
+{
+  uint32_t length=end-start;
+
+  if(channel < 0 || channel >= channels) return HISTORY_NO_CHANNEL;
+  if(length == 0) return HISTORY_OK;
+
+  uint32_t seq=sequence.load(std::memory_order_acquire);
+  uint32_t newest=endtime.load(std::memory_order_relaxed);
+  unsigned long available=filled.load(std::memory_order_relaxed);
+  if(available == 0) return HISTORY_NOT_YET;
+
+  // distance from the end of the range to the end of the history
+  if((int32_t)(newest-end) < 0) return HISTORY_NOT_YET;
+  // the oldest frame we have is newest-available
+  if(newest-start > available) return HISTORY_TOO_OLD;
+  // as end isn't after newest, only a range that runs backwards gets here
+  if(length > newest-start) return HISTORY_BAD_RANGE;
+
+  const float *history=buffer+channel*frames;
+  unsigned long position=start%frames;
+  if(position+length <= frames){
+    memcpy(data,history+position,length*sizeof(float));
+  }
+  else {
+    unsigned long first_chunk=frames-position;
+    memcpy(data,history+position,first_chunk*sizeof(float));
+    memcpy(data+first_chunk,history,(length-first_chunk)*sizeof(float));
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  uint32_t seqafter;
+  do { // a write is a few memcpy's, so it's done soon
+    seqafter=sequence.load(std::memory_order_acquire);
+  } while(seqafter & 1);
+  if(seqafter == seq) return HISTORY_OK;
+
+  /*
+   * The writer was busy. Every write since we started ended at or before
+   *  the current endtime, so the frames from endtime-filled on are still
+   *  intact. Our copy is good if it started there or later.
+   */
+  uint32_t nowend=endtime.load(std::memory_order_relaxed);
+  if((unsigned long)(nowend-start) <= filled.load(std::memory_order_relaxed)) return HISTORY_OK;
+
+  return HISTORY_OVERWRITTEN;
+} // read()
+
+
+/*
+ * Frame time just after the newest frame in the history
+ */
+uint32_t HistoryBuffer::getEndTime()
+{
+  return endtime.load(std::memory_order_acquire);
+} // getEndTime()
+
+
+unsigned long HistoryBuffer::getFrames()
+{
+  return frames;
+} // getFrames()
@@ -0,0 +1,66 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : history_buffer.h
+*  System name   : jack_module
+*
+*  Description   : history buffer class description
+*		   Keeps the most recent audio per channel, addressed by
+*		    frame time, with a seqlock for concurrent readers
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+#ifndef HISTORY_BUFFER_H
+#define HISTORY_BUFFER_H
+
+#include <atomic>
+#include <stdint.h>
+
+// return values of HistoryBuffer::read()
+#define HISTORY_OK 0
+#define HISTORY_NOT_YET -1 // (part of) the range is in the future
+#define HISTORY_TOO_OLD -2 // (part of) the range is no longer kept
+#define HISTORY_OVERWRITTEN -3 // overwritten while copying, try a later range
+#define HISTORY_NO_CHANNEL -4
+#define HISTORY_BAD_RANGE -5 // start after end
+
+class HistoryBuffer
+{
+public:
+  HistoryBuffer(int channels,unsigned long frames);
+  ~HistoryBuffer();
+  void write(float * const *channeldata,unsigned long nframes,uint32_t frametime);
+  int read(int channel,uint32_t start,uint32_t end,float *data);
+  uint32_t getEndTime();
+  unsigned long getFrames();
+private:
+  int channels;
+  unsigned long frames; // per channel
+  float *buffer; // channel after channel
+  std::atomic<uint32_t> sequence; // odd while write() is busy
+  std::atomic<uint32_t> endtime; // frame time just after the newest frame
+  std::atomic<unsigned long> filled; // #frames written, up to frames
+}; // HistoryBuffer{}
+
+#endif
@@ -0,0 +1,125 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : history_test.cpp
+*  System name   : jack_module
+*
+*  Description   : history buffer test
+*		   A writer thread plays the audio callback while a
+*		    reader copies out ranges near both ends of the history
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+#include "history_buffer.h"
+
+#define PERIOD 256
+#define HISTORYFRAMES 4096
+#define NPERIODS 2000
+#define RANGE 300
+
+
+/*
+ * Every frame holds its own frame time (modulo 2^16), for two channels
+ *  with opposite sign. The frame time starts just before the wrap.
+ */
+static float expected(int channel,uint32_t frametime)
+{
+  float value=frametime & 0xffff;
+  return channel ? -value : value;
+} // expected()
+
+
+int main()
+{
+HistoryBuffer history(2,HISTORYFRAMES);
+std::atomic<bool> running(true);
+const uint32_t firsttime=0xffffffff-100*PERIOD;
+unsigned long results[6]={0,0,0,0,0,0};
+unsigned long errors=0;
+
+  std::thread writer([&](){
+    float left[PERIOD],right[PERIOD];
+    float *channels[2]={left,right};
+    uint32_t frametime=firsttime;
+    for(int period=0; period<NPERIODS; period++){
+      for(int i=0; i<PERIOD; i++){
+        left[i]=expected(0,frametime+i);
+        right[i]=expected(1,frametime+i);
+      }
+      history.write(channels,PERIOD,frametime);
+      frametime+=PERIOD;
+      usleep(100); // give the reader a chance on a single core
+    }
+    running=false;
+  });
+
+  float data[RANGE];
+  unsigned long round=0;
+  while(running){
+    uint32_t end=history.getEndTime();
+    uint32_t start;
+    // alternate between the newest frames and the oldest ones
+    if(round%2) start=end-RANGE;
+    else start=end-history.getFrames()+(round%7);
+    int channel=round%2;
+    round++;
+
+    int result=history.read(channel,start,start+RANGE,data);
+    results[-result]++;
+    if(result == HISTORY_OK){
+      for(int i=0; i<RANGE; i++){
+        if(data[i] != expected(channel,start+i)) errors++;
+      }
+    }
+  }
+  writer.join();
+
+  std::cout << "ok: " << results[0] << " not yet: " << results[1] << " too old: " << results[2]
+            << " overwritten: " << results[3] << std::endl;
+
+  // a range that runs backwards
+  uint32_t end=history.getEndTime();
+  if(history.read(0,end-100,end-200,data) != HISTORY_BAD_RANGE) errors++;
+
+  // after a jump in frame time only the frames after it are valid
+  float left[PERIOD],right[PERIOD];
+  float *channels[2]={left,right};
+  for(int i=0; i<PERIOD; i++){
+    left[i]=expected(0,end+1000+i);
+    right[i]=expected(1,end+1000+i);
+  }
+  history.write(channels,PERIOD,end+1000);
+  end=history.getEndTime();
+  if(history.read(0,end-PERIOD-1,end,data) != HISTORY_TOO_OLD) errors++;
+  if(history.read(1,end-PERIOD,end,data) != HISTORY_OK || data[0] != expected(1,end-PERIOD)) errors++;
+
+  std::cout << "Wrong data in " << errors << " samples" << std::endl;
+
+  return errors == 0 ? 0 : 1;
+} // main()
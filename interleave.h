@@ -0,0 +1,228 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : interleave.h
+*  System name   : jack_module
+*
+*  Description   : (de)interleaving of sample frames for a channel
+*		   count that is known at compile time
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+#ifndef INTERLEAVE_H
+#define INTERLEAVE_H
+
+/*
+ * Interleaver<N> copies between N separate channel buffers and one
+ *  channel-interleaved buffer. The frames go in blocks of
+ *  INTERLEAVEBLOCK and the channel loop is unrolled through template
+ *  recursion, so each block is straight-line code.
+ *
+ * GCC doesn't vectorise the interleaving direction by itself at the -O2
+ *  of the Makefile (nor for most channel counts at -O3), so with SSE
+ *  each block is written out as vector code: four channels at a time
+ *  through a 4x4 transpose, a remaining pair through unpack/shuffle and
+ *  a last odd channel with scalar copies. Without SSE all channels use
+ *  the scalar copies.
+ */
+
+#include <string.h> // memcpy
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#define INTERLEAVE_SSE
+#endif
+
+#define INTERLEAVEBLOCK 4 // frames, as unrolled below
+
+template<int N,int Channel=0,int Left=N-Channel>
+struct InterleaveChannels;
+
+// one channel of one block of frames, starting at frame
+template<int N,int Channel>
+struct InterleaveChannel
+{
+  static inline void interleave(float *dst,float * const *src,unsigned long frame)
+  {
+    const float *s=src[Channel]+frame;
+    dst[Channel]=s[0];
+    dst[N+Channel]=s[1];
+    dst[2*N+Channel]=s[2];
+    dst[3*N+Channel]=s[3];
+    InterleaveChannels<N,Channel+1>::interleave(dst,src,frame);
+  }
+
+  static inline void deinterleave(float * const *dst,const float *src,unsigned long frame)
+  {
+    float *d=dst[Channel]+frame;
+    d[0]=src[Channel];
+    d[1]=src[N+Channel];
+    d[2]=src[2*N+Channel];
+    d[3]=src[3*N+Channel];
+    InterleaveChannels<N,Channel+1>::deinterleave(dst,src,frame);
+  }
+};
+
+#ifdef INTERLEAVE_SSE
+
+// four channels of one block: frames become channels and vice versa
+template<int N,int Channel,int Left>
+struct InterleaveChannels
+{
+  static inline void interleave(float *dst,float * const *src,unsigned long frame)
+  {
+    __m128 c0=_mm_loadu_ps(src[Channel]+frame);
+    __m128 c1=_mm_loadu_ps(src[Channel+1]+frame);
+    __m128 c2=_mm_loadu_ps(src[Channel+2]+frame);
+    __m128 c3=_mm_loadu_ps(src[Channel+3]+frame);
+    _MM_TRANSPOSE4_PS(c0,c1,c2,c3);
+    _mm_storeu_ps(dst+Channel,c0);
+    _mm_storeu_ps(dst+N+Channel,c1);
+    _mm_storeu_ps(dst+2*N+Channel,c2);
+    _mm_storeu_ps(dst+3*N+Channel,c3);
+    InterleaveChannels<N,Channel+4>::interleave(dst,src,frame);
+  }
+
+  static inline void deinterleave(float * const *dst,const float *src,unsigned long frame)
+  {
+    __m128 f0=_mm_loadu_ps(src+Channel);
+    __m128 f1=_mm_loadu_ps(src+N+Channel);
+    __m128 f2=_mm_loadu_ps(src+2*N+Channel);
+    __m128 f3=_mm_loadu_ps(src+3*N+Channel);
+    _MM_TRANSPOSE4_PS(f0,f1,f2,f3);
+    _mm_storeu_ps(dst[Channel]+frame,f0);
+    _mm_storeu_ps(dst[Channel+1]+frame,f1);
+    _mm_storeu_ps(dst[Channel+2]+frame,f2);
+    _mm_storeu_ps(dst[Channel+3]+frame,f3);
+    InterleaveChannels<N,Channel+4>::deinterleave(dst,src,frame);
+  }
+};
+
+// two channels of one block, two frames per vector on the interleaved side
+template<int N,int Channel>
+struct InterleavePair
+{
+  static inline void interleave(float *dst,float * const *src,unsigned long frame)
+  {
+    __m128 a=_mm_loadu_ps(src[Channel]+frame);
+    __m128 b=_mm_loadu_ps(src[Channel+1]+frame);
+    __m128 frames01=_mm_unpacklo_ps(a,b); // a0 b0 a1 b1
+    __m128 frames23=_mm_unpackhi_ps(a,b); // a2 b2 a3 b3
+    if(N == 2){ // stereo: the frames are next to each other
+      _mm_storeu_ps(dst,frames01);
+      _mm_storeu_ps(dst+4,frames23);
+    } else {
+      _mm_storel_pi((__m64 *)(dst+Channel),frames01);
+      _mm_storeh_pi((__m64 *)(dst+N+Channel),frames01);
+      _mm_storel_pi((__m64 *)(dst+2*N+Channel),frames23);
+      _mm_storeh_pi((__m64 *)(dst+3*N+Channel),frames23);
+    }
+    InterleaveChannels<N,Channel+2>::interleave(dst,src,frame);
+  }
+
+  static inline void deinterleave(float * const *dst,const float *src,unsigned long frame)
+  {
+    __m128 frames01,frames23;
+    if(N == 2){
+      frames01=_mm_loadu_ps(src);
+      frames23=_mm_loadu_ps(src+4);
+    } else {
+      frames01=_mm_loadl_pi(_mm_setzero_ps(),(const __m64 *)(src+Channel));
+      frames01=_mm_loadh_pi(frames01,(const __m64 *)(src+N+Channel));
+      frames23=_mm_loadl_pi(_mm_setzero_ps(),(const __m64 *)(src+2*N+Channel));
+      frames23=_mm_loadh_pi(frames23,(const __m64 *)(src+3*N+Channel));
+    }
+    _mm_storeu_ps(dst[Channel]+frame,_mm_shuffle_ps(frames01,frames23,_MM_SHUFFLE(2,0,2,0)));
+    _mm_storeu_ps(dst[Channel+1]+frame,_mm_shuffle_ps(frames01,frames23,_MM_SHUFFLE(3,1,3,1)));
+    InterleaveChannels<N,Channel+2>::deinterleave(dst,src,frame);
+  }
+};
+
+template<int N,int Channel>
+struct InterleaveChannels<N,Channel,3> : InterleavePair<N,Channel> {};
+
+template<int N,int Channel>
+struct InterleaveChannels<N,Channel,2> : InterleavePair<N,Channel> {};
+
+template<int N,int Channel>
+struct InterleaveChannels<N,Channel,1> : InterleaveChannel<N,Channel> {};
+
+#else
+
+template<int N,int Channel,int Left>
+struct InterleaveChannels : InterleaveChannel<N,Channel> {};
+
+#endif
+
+// end of the recursion
+template<int N,int Channel>
+struct InterleaveChannels<N,Channel,0>
+{
+  static inline void interleave(float *,float * const *,unsigned long) {}
+  static inline void deinterleave(float * const *,const float *,unsigned long) {}
+};
+
+
+template<int N>
+struct Interleaver
+{
+  static void interleave(float *dst,float * const *src,unsigned long nframes)
+  {
+    unsigned long frame=0;
+    for(; frame+INTERLEAVEBLOCK<=nframes; frame+=INTERLEAVEBLOCK){
+      InterleaveChannels<N>::interleave(dst+frame*N,src,frame);
+    }
+    // JACK periods are powers of two, so normally nothing is left
+    for(; frame<nframes; frame++){
+      for(int channel=0; channel<N; channel++) dst[frame*N+channel]=src[channel][frame];
+    }
+  }
+
+  static void deinterleave(float * const *dst,const float *src,unsigned long nframes)
+  {
+    unsigned long frame=0;
+    for(; frame+INTERLEAVEBLOCK<=nframes; frame+=INTERLEAVEBLOCK){
+      InterleaveChannels<N>::deinterleave(dst,src+frame*N,frame);
+    }
+    for(; frame<nframes; frame++){
+      for(int channel=0; channel<N; channel++) dst[channel][frame]=src[frame*N+channel];
+    }
+  }
+};
+
+// a single channel is the same interleaved or not
+template<>
+struct Interleaver<1>
+{
+  static void interleave(float *dst,float * const *src,unsigned long nframes)
+  {
+    memcpy(dst,src[0],nframes*sizeof(float));
+  }
+
+  static void deinterleave(float * const *dst,const float *src,unsigned long nframes)
+  {
+    memcpy(dst[0],src,nframes*sizeof(float));
+  }
+};
+
+#endif
@@ -0,0 +1,235 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : jack_async.h
+*  System name   : jack_module
+*
+*  Description   : C++20 coroutine interface for JackModule
+*		   One thread serves many modules through an epoll
+*		    based event loop
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+#ifndef JACK_ASYNC_H
+#define JACK_ASYNC_H
+
+#if __cplusplus < 202002L
+#error "jack_async.h needs C++20 (coroutines), compile with --std=c++20"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <vector>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include "jack_module.h"
+
+/*
+ * Usage:
+ *
+ *    JackEventLoop loop;
+ *    AsyncJack stream(loop,jack); // after jack.init()
+ *
+ *    JackTask play(AsyncJack &stream)
+ *    {
+ *      while(...){
+ *        ... fill buffer
+ *        if(co_await stream.write(buffer,n) == 0) break; // JACK stopped
+ *      }
+ *    }
+ *
+ *    play(stream);
+ *    loop.run(); // returns when no coroutine is waiting anymore
+ *
+ * The JACK callback signals each module's eventfd once per period. The
+ *  loop then retries every waiting read or write and resumes the
+ *  coroutines that could complete. Nothing spins or sleeps.
+ *
+ * A transfer completes as a whole, like readSamples() and writeSamples().
+ *  When the module is no longer running the await returns 0.
+ *  Everything runs on the thread that calls run().
+ */
+
+
+/*
+ * Return type for coroutines that are started and then left to the
+ *  event loop: they run until their first co_await right away and
+ *  clean up after themselves when they finish
+ */
+struct JackTask
+{
+  struct promise_type
+  {
+    JackTask get_return_object() { return JackTask(); }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+}; // JackTask{}
+
+
+class JackEventLoop
+{
+public:
+  struct Waiter
+  {
+    JackModule *jack;
+    float *data;
+    unsigned long n;
+    bool write;
+    unsigned long result;
+    std::coroutine_handle<> handle;
+  };
+
+  JackEventLoop()
+  {
+    epollfd=epoll_create1(EPOLL_CLOEXEC);
+  }
+
+  ~JackEventLoop()
+  {
+    if(epollfd >= 0) close(epollfd);
+  }
+
+  /*
+   * Watch the eventfd of a module, returns -1 on failure
+   */
+  int add(JackModule &jack)
+  {
+    int fd=jack.getEventFd();
+    if(fd < 0 || epollfd < 0) return -1;
+    struct epoll_event event;
+    event.events=EPOLLIN;
+    event.data.fd=fd;
+    if(epoll_ctl(epollfd,EPOLL_CTL_ADD,fd,&event) < 0) return -1;
+    return 0;
+  }
+
+  void suspend(Waiter *waiter)
+  {
+    waiters.push_back(waiter);
+  }
+
+  /*
+   * Serve waiting coroutines until none is left or stop() is called
+   */
+  void run()
+  {
+    struct epoll_event events[16];
+    uint64_t count;
+
+    stopping=false;
+    while(!stopping && !waiters.empty()){
+      int nevents=epoll_wait(epollfd,events,16,-1);
+      for(int i=0; i<nevents; i++){
+        if(read(events[i].data.fd,&count,sizeof(count)) < 0) {} // reset
+      }
+
+      // resuming may add new waiters, so work on the current set only
+      std::vector<Waiter *> pending;
+      pending.swap(waiters);
+      for(Waiter *waiter : pending){
+        if(attempt(waiter)) waiter->handle.resume();
+        else waiters.push_back(waiter);
+      }
+    } // while
+  }
+
+  void stop()
+  {
+    stopping=true;
+  }
+
+  /*
+   * Try to complete a transfer without blocking. Also completes, with
+   *  result 0, when the module has stopped running. With auto-reconnect
+   *  a lost server isn't the end: the transfer waits for the reconnect.
+   */
+  static bool attempt(Waiter *waiter)
+  {
+    if(waiter->write) waiter->result=waiter->jack->tryWriteSamples(waiter->data,waiter->n);
+    else waiter->result=waiter->jack->tryReadSamples(waiter->data,waiter->n);
+    if(waiter->result > 0 || waiter->n == 0) return true;
+    switch(waiter->jack->getState()){
+      case JackModule::RUNNING:
+      case JackModule::RECONNECTING:
+        return false;
+      case JackModule::SERVER_LOST: // the supervisor is about to reconnect
+        return !waiter->jack->getAutoReconnect();
+      default:
+        return true;
+    }
+  }
+
+private:
+  int epollfd;
+  bool stopping=false;
+  std::vector<Waiter *> waiters;
+}; // JackEventLoop{}
+
+
+/*
+ * A JackModule as seen from coroutines: co_await read() and write()
+ *  return the number of samples transferred
+ */
+class AsyncJack
+{
+public:
+  struct Transfer
+  {
+    JackEventLoop *loop;
+    JackEventLoop::Waiter waiter;
+
+    bool await_ready() { return JackEventLoop::attempt(&waiter); }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+      waiter.handle=handle;
+      loop->suspend(&waiter);
+    }
+    unsigned long await_resume() { return waiter.result; }
+  };
+
+  AsyncJack(JackEventLoop &loop,JackModule &jack) : loop(loop),jack(jack)
+  {
+    loop.add(jack);
+  }
+
+  Transfer read(float *data,unsigned long n)
+  {
+    return Transfer{&loop,{&jack,data,n,false,0,nullptr}};
+  }
+
+  Transfer write(float *data,unsigned long n)
+  {
+    return Transfer{&loop,{&jack,data,n,true,0,nullptr}};
+  }
+
+private:
+  JackEventLoop &loop;
+  JackModule &jack;
+}; // AsyncJack{}
+
+#endif
@@ -0,0 +1,110 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : jack_async_test.cpp
+*  System name   : jack_module
+*
+*  Description   : Test program for the coroutine interface
+*		   Same as jack_test but playback and analysis are
+*		    coroutines sharing a single thread
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+#include <iostream>
+#include <cmath>
+#include "jack_module.h"
+#include "jack_async.h"
+
+unsigned long anachunksize=2048;
+unsigned long synthchunksize=1024;
+
+unsigned long samplerate=44100; // default
+
+
+/*
+ * play coroutine generates audio samples and writes these to JACK
+ */
+static JackTask play(AsyncJack &jack,unsigned long nframes)
+{
+std::vector<float> synthbuffer(synthchunksize);
+unsigned long nplayed=0;
+double phase=0;
+
+  do {
+    for(unsigned long i=0; i<synthchunksize; i++){
+      synthbuffer[i]=0.4*sin(phase);
+      phase += 880*2*M_PI/(double)samplerate;
+    } // for
+
+    if(co_await jack.write(synthbuffer.data(),synthchunksize) == 0) break;
+    nplayed+=synthchunksize;
+  } while(nplayed < nframes);
+} // play()
+
+
+/*
+ * analysis coroutine reads audio samples from JACK and reports the level
+ */
+static JackTask analysis(AsyncJack &jack,unsigned long nframes)
+{
+std::vector<float> anabuffer(anachunksize);
+unsigned long nread=0;
+
+  do {
+    if(co_await jack.read(anabuffer.data(),anachunksize) == 0) break;
+
+    float peak=0;
+    for(unsigned long frame=0; frame<anachunksize; frame++){
+      if(fabs(anabuffer[frame]) > peak) peak=fabs(anabuffer[frame]);
+    }
+    std::cout << "peak " << peak << std::endl;
+
+    nread+=anachunksize;
+  } while(nread < nframes);
+} // analysis()
+
+
+int main(int argc,char **argv)
+{
+JackModule jack;
+JackEventLoop loop;
+
+  jack.setNumberOfInputChannels(1);
+  jack.setNumberOfOutputChannels(1);
+  if(jack.init(argv[0])) return 1; // use program name as JACK client name
+  jack.autoConnect();
+
+  samplerate=jack.getSamplerate();
+  std::cerr << "Samplerate: " << samplerate << std::endl;
+
+  AsyncJack stream(loop,jack);
+  play(stream,samplerate*5);
+  analysis(stream,samplerate*5);
+  loop.run();
+
+  jack.end();
+
+  return 0;
+} // main()
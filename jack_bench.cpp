@@ -0,0 +1,378 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : jack_bench.cpp
+*  System name   : jack_module
+*
+*  Description   : JACK module benchmark
+*		   Callback cost versus channel count and end-to-end
+*		    round-trip latency through a loopback connection.
+*		    Results are written as JSON.
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <unistd.h>
+#include "jack_module.h"
+#include "jack_client.h"
+#include "jack_module_t.h"
+
+/*
+ * Usage: jack_bench [outputfile.json]
+ *
+ * Meant to run against a JACK server with the dummy driver, so the
+ *  results don't depend on audio hardware, e.g.
+ *
+ *    jackd -d dummy -r 48000 -p 256
+ *
+ * The period is taken from the running server; jack_bench.sh runs the
+ *  benchmark for a range of periods.
+ *
+ * JackModule reports buffer under- and overruns on stdout, so pass a
+ *  filename to keep the JSON output clean.
+ */
+
+#define BENCH_RINGBUFSIZE 16384
+#define LOADSAMPLES 20
+#define IMPULSES 50
+#define IMPULSEINTERVAL 16 // blocks
+#define MAXTIMINGS 65536 // callbacks timed per module
+
+typedef std::chrono::steady_clock benchclock;
+
+
+/*
+ * Module that measures how long each of its own onProcess() calls
+ *  takes. The times go into memory reserved beforehand, so timing
+ *  doesn't allocate in the process callback.
+ */
+template<class Module>
+class TimedModule : public Module
+{
+public:
+  TimedModule(unsigned long inbufsize,unsigned long outbufsize) :
+    Module(inbufsize,outbufsize), timings(MAXTIMINGS), ntimings(0), timing(false) {}
+  void startTiming() { ntimings=0; timing=true; }
+  void stopTiming() { timing=false; }
+  std::vector<double> getTimings() // usec, sorted
+  {
+    std::vector<double> result(timings.begin(),timings.begin()+ntimings);
+    std::sort(result.begin(),result.end());
+    return result;
+  }
+protected:
+  int onProcess(jack_nframes_t nframes) override
+  {
+    if(!timing || ntimings >= MAXTIMINGS) return Module::onProcess(nframes);
+    auto start=benchclock::now();
+    int result=Module::onProcess(nframes);
+    timings[ntimings]=std::chrono::duration<double,std::micro>(benchclock::now()-start).count();
+    ntimings++;
+    return result;
+  }
+private:
+  std::vector<double> timings;
+  std::atomic<unsigned long> ntimings;
+  std::atomic<bool> timing;
+}; // TimedModule{}
+
+
+static void printTimings(std::ostream &out,const char *name,const std::vector<double> &sorted)
+{
+  out << "\"" << name << "\": ";
+  if(sorted.empty()) {
+    out << "null";
+    return;
+  }
+  double sum=0;
+  for(double t : sorted) sum+=t;
+  out << "{\"mean\": " << sum/sorted.size()
+      << ", \"p50\": " << sorted[sorted.size()/2]
+      << ", \"p99\": " << sorted[(sorted.size()-1)*99/100]
+      << ", \"max\": " << sorted.back()
+      << ", \"callbacks\": " << sorted.size()
+      << "}";
+} // printTimings()
+
+
+/*
+ * Time onProcess() of a module with the given number of input and
+ *  output channels while a worker thread keeps its ringbuffers going.
+ *  The DSP load of the server (all clients and the driver) is reported
+ *  alongside for reference.
+ *
+ * layout tells whether the channel count is set at runtime ("dynamic")
+ *  or fixed at compile time ("fixed", JackModuleT)
+ */
+template<class Module>
+static bool benchCallback(std::ostream &out,TimedModule<Module> &jack,
+                          const char *layout,int channels,bool first)
+{
+std::atomic<bool> running(true);
+std::ostringstream clientname;
+
+  clientname << "jack_bench_" << layout << "_" << channels << "ch";
+  if(jack.init(clientname.str())) return false;
+
+  unsigned long period=jack.getBuffersize();
+  unsigned long samplerate=jack.getSamplerate();
+
+  // worker in lockstep with the callback: one period out, one period in
+  std::thread worker([&](){
+    std::vector<float> block(period*channels,0.0);
+    while(running){
+      jack.writeSamples(block.data(),period*channels);
+      jack.readSamples(block.data(),period*channels);
+    }
+  });
+
+  usleep(500000); // settle
+  jack.startTiming();
+  double load=0;
+  for(int i=0; i<LOADSAMPLES; i++){
+    usleep(100000);
+    load+=jack.getCpuLoad();
+  }
+  load/=LOADSAMPLES;
+  jack.stopTiming();
+
+  running=false;
+  worker.join();
+  jack.end();
+
+  if(!first) out << ",\n";
+  out << "    {\"layout\": \"" << layout << "\""
+      << ", \"channels\": " << channels
+      << ", \"period\": " << period
+      << ", \"samplerate\": " << samplerate
+      << ", \"period_us\": " << 1e6*period/samplerate
+      << ", ";
+  printTimings(out,"callback_us",jack.getTimings());
+  out << ", \"server_dsp_load_percent\": " << load
+      << "}";
+  return true;
+} // benchCallback()
+
+
+/*
+ * Time onProcess() of a number of stereo streams, either each with a
+ *  JACK client of its own or all sharing one JackClient, and the DSP
+ *  load of the server, which includes JACK's cost per client
+ */
+static bool benchStreams(std::ostream &out,int nstreams,bool shared,bool first)
+{
+JackClient host;
+std::vector<std::unique_ptr<TimedModule<JackModule> > > streams;
+std::vector<std::thread> workers;
+std::atomic<bool> running(true);
+
+  if(shared && host.open("jack_bench_shared")) return false;
+
+  for(int i=0; i<nstreams; i++){
+    std::ostringstream name;
+    name << "jack_bench_stream" << i;
+    TimedModule<JackModule> *stream = new TimedModule<JackModule>(BENCH_RINGBUFSIZE,BENCH_RINGBUFSIZE);
+    streams.push_back(std::unique_ptr<TimedModule<JackModule> >(stream));
+    if(shared ? stream->init(host,name.str()) : stream->init(name.str())) return false;
+  }
+
+  unsigned long period=streams[0]->getBuffersize();
+  unsigned long samplerate=streams[0]->getSamplerate();
+
+  for(int i=0; i<nstreams; i++){
+    JackModule *stream=streams[i].get();
+    workers.push_back(std::thread([stream,period,&running](){
+      std::vector<float> block(period*2,0.0);
+      while(running){
+        stream->writeSamples(block.data(),period*2);
+        stream->readSamples(block.data(),period*2);
+      }
+    }));
+  }
+
+  usleep(500000); // settle
+  for(int i=0; i<nstreams; i++) streams[i]->startTiming();
+  double load=0;
+  for(int i=0; i<LOADSAMPLES; i++){
+    usleep(100000);
+    load+=streams[0]->getCpuLoad();
+  }
+  load/=LOADSAMPLES;
+  for(int i=0; i<nstreams; i++) streams[i]->stopTiming();
+
+  running=false;
+  for(unsigned int i=0; i<workers.size(); i++) workers[i].join();
+  for(int i=0; i<nstreams; i++) streams[i]->end();
+  host.close();
+
+  // all callbacks of all streams together
+  std::vector<double> timings;
+  for(int i=0; i<nstreams; i++){
+    std::vector<double> stream=streams[i]->getTimings();
+    timings.insert(timings.end(),stream.begin(),stream.end());
+  }
+  std::sort(timings.begin(),timings.end());
+
+  if(!first) out << ",\n";
+  out << "    {\"streams\": " << nstreams
+      << ", \"shared_client\": " << (shared ? "true" : "false")
+      << ", \"period\": " << period
+      << ", \"samplerate\": " << samplerate
+      << ", ";
+  printTimings(out,"callback_us_per_stream",timings);
+  out << ", \"server_dsp_load_percent\": " << load
+      << "}";
+  return true;
+} // benchStreams()
+
+
+/*
+ * Send impulses through our own output, back into our own input and
+ *  count the samples between the position of an impulse in the output
+ *  stream and where it shows up in the input stream. Counting samples
+ *  rather than timing the calls keeps the blocking nap of readSamples()
+ *  out of the result.
+ */
+static void benchRoundtrip(std::ostream &out)
+{
+JackModule jack(BENCH_RINGBUFSIZE,BENCH_RINGBUFSIZE);
+std::vector<unsigned long> latency; // frames
+
+  jack.setNumberOfInputChannels(1);
+  jack.setNumberOfOutputChannels(1);
+  if(jack.init("jack_bench_rt")){
+    out << "  \"roundtrip\": null\n";
+    return;
+  }
+  jack.autoConnect("jack_bench_rt","jack_bench_rt"); // loopback
+
+  unsigned long period=jack.getBuffersize();
+  unsigned long samplerate=jack.getSamplerate();
+  std::vector<float> outblock(period,0.0);
+  std::vector<float> inblock(period);
+  unsigned long written=0,read=0; // frames so far
+  unsigned long sent=0;
+  unsigned long impulses=0; // not while the previous one is pending
+  bool pending=false;
+
+  for(unsigned long block=0; block<(IMPULSES+1)*IMPULSEINTERVAL; block++){
+    outblock[0]=0.0;
+    if(block%IMPULSEINTERVAL == 0 && !pending){
+      outblock[0]=1.0;
+      sent=written;
+      impulses++;
+      pending=true;
+    }
+    written+=jack.writeSamples(outblock.data(),period);
+    unsigned long n=jack.readSamples(inblock.data(),period);
+    for(unsigned long i=0; i<n && pending; i++){
+      if(inblock[i] > 0.5){
+        latency.push_back(read+i-sent);
+        pending=false;
+      }
+    }
+    read+=n;
+  }
+
+  jack.end();
+  std::sort(latency.begin(),latency.end());
+
+  out << "  \"roundtrip\": {\"period\": " << period
+      << ", \"samplerate\": " << samplerate
+      << ", \"impulses_sent\": " << impulses
+      << ", \"impulses_received\": " << latency.size();
+  if(!latency.empty()){
+    unsigned long percentiles[]={latency.front(),latency[latency.size()/2],
+      latency[(latency.size()-1)*9/10],latency.back()};
+    const char *names[]={"min","p50","p90","max"};
+    out << ", \"latency_frames\": {";
+    for(int i=0; i<4; i++) out << (i ? ", \"" : "\"") << names[i] << "\": " << percentiles[i];
+    out << "}, \"latency_us\": {";
+    for(int i=0; i<4; i++) out << (i ? ", \"" : "\"") << names[i] << "\": " << 1e6*percentiles[i]/samplerate;
+    out << "}";
+  }
+  out << "}\n";
+} // benchRoundtrip()
+
+
+int main(int argc,char **argv)
+{
+std::ofstream outfile;
+bool first=true;
+
+  if(argc > 1) outfile.open(argv[1]);
+  std::ostream &out = (argc > 1) ? outfile : std::cout;
+
+  int maxchannels = MAXINPUTCHANNELS < MAXOUTPUTCHANNELS ?
+    MAXINPUTCHANNELS : MAXOUTPUTCHANNELS;
+
+  out << "{\n  \"benchmark\": \"jack_module\",\n";
+  out << "  \"callback\": [\n";
+  for(int channels=1; channels<=maxchannels; channels++){
+    TimedModule<JackModule> jack(BENCH_RINGBUFSIZE,BENCH_RINGBUFSIZE);
+    jack.setNumberOfInputChannels(channels);
+    jack.setNumberOfOutputChannels(channels);
+    if(benchCallback(out,jack,"dynamic",channels,first)) first=false;
+  }
+  {
+    TimedModule<JackModuleMono> jack(BENCH_RINGBUFSIZE,BENCH_RINGBUFSIZE);
+    if(benchCallback(out,jack,"fixed",1,first)) first=false;
+  }
+  {
+    TimedModule<JackModuleStereo> jack(BENCH_RINGBUFSIZE,BENCH_RINGBUFSIZE);
+    if(benchCallback(out,jack,"fixed",2,first)) first=false;
+  }
+  {
+    TimedModule<JackModule51> jack(BENCH_RINGBUFSIZE,BENCH_RINGBUFSIZE);
+    if(benchCallback(out,jack,"fixed",6,first)) first=false;
+  }
+  {
+    TimedModule<JackModule71> jack(BENCH_RINGBUFSIZE,BENCH_RINGBUFSIZE);
+    if(benchCallback(out,jack,"fixed",8,first)) first=false;
+  }
+  out << "\n  ],\n";
+
+  int nstreams[]={1,4,16};
+  first=true;
+  out << "  \"streams\": [\n";
+  for(int n : nstreams){
+    if(benchStreams(out,n,false,first)) first=false;
+    if(benchStreams(out,n,true,first)) first=false;
+  }
+  out << "\n  ],\n";
+
+  benchRoundtrip(out);
+  out << "}\n";
+
+  return 0;
+} // main()
@@ -0,0 +1,25 @@
+#!/bin/sh
+#
+# Run jack_bench against a dummy-driver JACK server for a range of periods
+#  and collect the JSON results in bench_results/
+#
+# Usage: ./jack_bench.sh [samplerate]
+#
+
+SAMPLERATE=${1:-48000}
+PERIODS="64 128 256 512 1024"
+
+mkdir -p bench_results
+./ringbuffer_bench bench_results/ringbuffer.json
+./resampler_bench bench_results/resampler.json
+./allocator_bench bench_results/allocator.json
+
+for PERIOD in $PERIODS
+do
+  jackd -d dummy -r $SAMPLERATE -p $PERIOD > /dev/null 2>&1 &
+  JACKPID=$!
+  sleep 1
+  ./jack_bench bench_results/jack_${SAMPLERATE}_${PERIOD}.json > /dev/null
+  kill $JACKPID
+  wait $JACKPID 2> /dev/null
+done
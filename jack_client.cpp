@@ -0,0 +1,264 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : jack_client.cpp
+*  System name   : jack_module
+*
+*  Description   : one JACK client shared by several JackModule streams
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+/*
+ * Every JackModule normally is a JACK client of its own, so JACK runs
+ *  every one of them as a separate node in its graph, each with its own
+ *  thread wakeup per period. A JackClient hosts any number of modules
+ *  (streams) in one client instead: each stream still has its own ports
+ *  and ringbuffers, but they are all serviced from one process callback.
+ *
+ * Usage:
+ *
+ *    JackClient client;
+ *    client.open("SuperSynth");
+ *    JackModule voice1, voice2;
+ *    voice1.init(client,"voice1");
+ *    voice2.init(client,"voice2");
+ *
+ * Streams can be added and removed while the client is running.
+ */
+
+#include <iostream>
+#include <mutex>
+#include <unistd.h> // usleep
+
+#include "jack_client.h"
+#include "jack_trace.h"
+
+
+JackClient::JackClient()
+{
+  client=NULL;
+  for(int i=0; i<MAXSTREAMS; i++) streams[i]=NULL;
+  nstreams=0;
+  cycle=0;
+} // JackClient()
+
+
+JackClient::~JackClient()
+{
+  close();
+} // ~JackClient()
+
+
+int JackClient::open(std::string clientName)
+{
+  if( (client=jack_client_open(clientName.c_str(),JackNoStartServer,NULL)) == 0) {
+    std::cout << "JACK server not running ?" << std::endl;
+    return 1;
+  }
+
+  jack_on_shutdown(client,_wrap_jack_shutdown_cb,this);
+  jack_set_process_callback(client,_wrap_jack_process_cb,this);
+  jack_set_sample_rate_callback(client,_wrap_jack_samplerate_cb,this);
+  jack_set_buffer_size_callback(client,_wrap_jack_buffersize_cb,this);
+  jack_set_port_registration_callback(client,_wrap_jack_port_registration_cb,this);
+
+  if(jack_activate(client)) {
+    std::cout << "cannot activate client" << std::endl;
+    jack_client_close(client);
+    client=NULL;
+    return -1;
+  } // if
+
+  return 0;
+} // open()
+
+
+/*
+ * Streams should be ended before closing the client
+ */
+void JackClient::close()
+{
+  if(client == NULL) return;
+  jack_deactivate(client);
+  jack_client_close(client);
+  client=NULL;
+} // close()
+
+
+jack_client_t *JackClient::getClient()
+{
+  return client;
+} // getClient()
+
+
+/*
+ * Called by JackModule::init(), returns -1 if there's no room.
+ *  Streams may be added while the callback runs, but not from several
+ *  threads at the same time.
+ */
+int JackClient::addStream(JackModule *stream)
+{
+  // reuse an empty slot if there is one
+  for(int i=0; i<nstreams; i++){
+    JackModule *expected=NULL;
+    if(streams[i].compare_exchange_strong(expected,stream)) return 0;
+  }
+
+  int slot=nstreams;
+  if(slot >= MAXSTREAMS) return -1;
+  streams[slot]=stream;
+  nstreams=slot+1; // publish
+  return 0;
+} // addStream()
+
+
+/*
+ * Called by JackModule::end(). When this returns, none of the callbacks
+ *  uses the stream anymore.
+ */
+void JackClient::removeStream(JackModule *stream)
+{
+  {
+    // waits for a shutdown, sample rate or port callback in progress
+    std::lock_guard<std::mutex> lock(callbackmutex);
+    for(int i=0; i<nstreams; i++){
+      if(streams[i] == stream) streams[i]=NULL;
+    }
+  }
+
+  // if the callback is running it may still be using the stream
+  unsigned long current=cycle.load();
+  if(current & 1){
+    while(cycle.load() == current) usleep(100);
+  }
+} // removeStream()
+
+
+int JackClient::_wrap_jack_process_cb(jack_nframes_t nframes,void *arg)
+{
+  return ((JackClient *)arg)->onProcess(nframes);
+} // _wrap_jack_process_cb()
+
+
+void JackClient::_wrap_jack_shutdown_cb(void *arg)
+{
+  ((JackClient *)arg)->onShutdown();
+} // _wrap_jack_shutdown_cb()
+
+
+int JackClient::_wrap_jack_samplerate_cb(jack_nframes_t samplerate,void *arg)
+{
+  return ((JackClient *)arg)->onSamplerate(samplerate);
+} // _wrap_jack_samplerate_cb()
+
+
+int JackClient::_wrap_jack_buffersize_cb(jack_nframes_t nframes,void *arg)
+{
+  return ((JackClient *)arg)->onBuffersize(nframes);
+} // _wrap_jack_buffersize_cb()
+
+
+void JackClient::_wrap_jack_port_registration_cb(jack_port_id_t,int,void *arg)
+{
+  ((JackClient *)arg)->onPortRegistration();
+} // _wrap_jack_port_registration_cb()
+
+
+int JackClient::onProcess(jack_nframes_t nframes)
+{
+  JACK_TRACE_SPAN("JackClient::onProcess");
+  cycle++; // odd: busy
+
+  int n=nstreams;
+  for(int i=0; i<n; i++){
+    JackModule *stream=streams[i];
+    if(stream) stream->onProcess(nframes);
+  }
+
+  cycle++; // even: done
+  return 0;
+} // onProcess()
+
+
+/*
+ * The client is gone, so are all the streams
+ *
+ * This and the next callbacks run on a JACK thread that's not real-time,
+ *  so unlike onProcess() they can simply lock out removeStream().
+ */
+void JackClient::onShutdown()
+{
+  std::lock_guard<std::mutex> lock(callbackmutex);
+  int n=nstreams;
+  for(int i=0; i<n; i++){
+    JackModule *stream=streams[i];
+    if(stream) stream->onShutdown();
+  }
+} // onShutdown()
+
+
+/*
+ * Streams with an application sample rate need new resamplers
+ */
+int JackClient::onSamplerate(jack_nframes_t samplerate)
+{
+  std::lock_guard<std::mutex> lock(callbackmutex);
+  int n=nstreams;
+  for(int i=0; i<n; i++){
+    JackModule *stream=streams[i];
+    if(stream) stream->onSamplerate(samplerate);
+  }
+  return 0;
+} // onSamplerate()
+
+
+/*
+ * Streams refuse periods larger than MAXBUFFERSIZE
+ */
+int JackClient::onBuffersize(jack_nframes_t nframes)
+{
+  std::lock_guard<std::mutex> lock(callbackmutex);
+  int result=0;
+  int n=nstreams;
+  for(int i=0; i<n; i++){
+    JackModule *stream=streams[i];
+    if(stream && stream->onBuffersize(nframes)) result=-1;
+  }
+  return result;
+} // onBuffersize()
+
+
+/*
+ * Every stream keeps its own port list for autoConnect() etc.
+ */
+void JackClient::onPortRegistration()
+{
+  std::lock_guard<std::mutex> lock(callbackmutex);
+  int n=nstreams;
+  for(int i=0; i<n; i++){
+    JackModule *stream=streams[i];
+    if(stream) stream->onPortRegistration();
+  }
+} // onPortRegistration()
@@ -0,0 +1,72 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : jack_client.h
+*  System name   : jack_module
+*
+*  Description   : one JACK client shared by several JackModule streams
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+#ifndef JACK_CLIENT_H
+#define JACK_CLIENT_H
+
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <jack/jack.h>
+#include "jack_module.h"
+
+#define MAXSTREAMS 64
+
+
+class JackClient
+{
+public:
+  JackClient();
+  ~JackClient();
+  int open(std::string clientName);
+  void close();
+  jack_client_t *getClient();
+  int addStream(JackModule *stream);
+  void removeStream(JackModule *stream);
+private:
+  static int _wrap_jack_process_cb(jack_nframes_t nframes,void *arg);
+  static void _wrap_jack_shutdown_cb(void *arg);
+  static int _wrap_jack_samplerate_cb(jack_nframes_t samplerate,void *arg);
+  static int _wrap_jack_buffersize_cb(jack_nframes_t nframes,void *arg);
+  static void _wrap_jack_port_registration_cb(jack_port_id_t port,int registered,void *arg);
+  int onProcess(jack_nframes_t nframes);
+  void onShutdown();
+  int onSamplerate(jack_nframes_t samplerate);
+  int onBuffersize(jack_nframes_t nframes);
+  void onPortRegistration();
+  jack_client_t *client;
+  std::atomic<JackModule *> streams[MAXSTREAMS];
+  std::atomic<int> nstreams; // slots in use, some may be empty
+  std::atomic<unsigned long> cycle; // odd while in onProcess()
+  std::mutex callbackmutex; // the other callbacks against removeStream()
+}; // JackClient{}
+
+#endif
@@ -34,12 +34,14 @@
 #include <iostream>
 #include <sstream>
 #include <mutex>
+#include <chrono>
 #include <unistd.h> // usleep
+#include <sys/eventfd.h>
+#include <string.h> // memset
 
 #include "jack_module.h"
-
-// prototypes & globals
-static void jack_shutdown(void *);
+#include "jack_client.h"
+#include "jack_trace.h"
 
 /* ring buffer size depends partly on memory contraints but e.g.
  *  the tail of incoming audio to process may be a reason to request
@@ -48,9 +50,47 @@ static void jack_shutdown(void *);
 #define DEFAULT_INRINGBUFSIZE 30000
 #define DEFAULT_OUTRINGBUFSIZE 30000
 
+// delay between reconnection attempts doubles from MIN to MAX
+#define MINRECONNECTDELAY 50 // msec
+#define MAXRECONNECTDELAY 5000 // msec
+
+
+/*
+ * Everything onProcess() needs to convert between the JACK sample rate
+ *  and the application sample rate, for one JACK rate. Without resamplers
+ *  both rates are the same and the audio passes unchanged.
+ */
+struct RateConversion
+{
+  unsigned long jackrate;
+  unsigned long maxframes; // application frames per period, at most
+  Resampler *input=NULL; // JACK rate to application rate
+  Resampler *output=NULL; // application rate to JACK rate
+  float *planar=NULL; // maxframes per channel
+  float *channels[MAXINPUTCHANNELS > MAXOUTPUTCHANNELS ? MAXINPUTCHANNELS : MAXOUTPUTCHANNELS];
+  float *interleaved=NULL; // maxframes frames
+
+  ~RateConversion()
+  {
+    delete input;
+    delete output;
+    delete [] planar;
+    delete [] interleaved;
+  }
+}; // RateConversion{}
+
 
 JackModule::JackModule()
 {
+  client=NULL;
+  state=CLOSED;
+  conversion=NULL;
+  pendingconversion=NULL;
+  retiredconversion=NULL;
+  inputlatency=0;
+  outputlatency=0;
+  jacknode=-1;
+  eventfd=-1;
   inputringbuffer = new RingBuffer(DEFAULT_INRINGBUFSIZE,"in"); // audio in
   inputringbuffer->popMayBlock(true);
   inputringbuffer->setBlockingNap(500); // usec
@@ -62,6 +102,15 @@ JackModule::JackModule()
 
 JackModule::JackModule(unsigned long inbufsize, unsigned long outbufsize)
 {
+  client=NULL;
+  state=CLOSED;
+  conversion=NULL;
+  pendingconversion=NULL;
+  retiredconversion=NULL;
+  inputlatency=0;
+  outputlatency=0;
+  jacknode=-1;
+  eventfd=-1;
   inputringbuffer = new RingBuffer(inbufsize,"in"); // audio in
   inputringbuffer->popMayBlock(true);
   inputringbuffer->setBlockingNap(500); // usec
@@ -74,10 +123,23 @@ JackModule::JackModule(unsigned long inbufsize, unsigned long outbufsize)
 JackModule::~JackModule()
 {
   end();
+  delete inputringbuffer;
+  delete outputringbuffer;
+  delete [] windowhistory;
+  delete [] windowinput;
+  delete [] windowcoefficients;
+  delete [] windowedframe;
+  delete history;
+  if(eventfd >= 0) close(eventfd);
+  delete conversion.load();
+  delete pendingconversion.load();
+  delete retiredconversion.load();
+  if(tempbuffer != tempstorage) allocator->release(tempbuffer,sizeof(tempstorage));
 } // ~JackModule()
 
 
 
+
 int JackModule::init()
 {
   return init("JackModule");
@@ -91,55 +153,172 @@ int JackModule::init(std::string clientName)
    * output ports without connecting them.
    *
    * clientName: name of this client in the JACK connection overview
-   * JackNoStartServer : do not try to start the server
-   * JackNullOption or (jack_options_t)0 to try starting the
-   *   server if it's not already running
    */
 
-  if( (client=jack_client_open(clientName.c_str(),JackNoStartServer,NULL)) == 0) {
-    std::cout << "JACK server not running ?" << std::endl;
-    return 1;
+  this->clientName=clientName;
+
+  int result=openClient();
+  if(result) return result;
+
+  startStream();
+  if(autoReconnect) supervisor=std::thread(&JackModule::supervise,this);
+
+  return 0;
+} // init()
+
+
+/*
+ * Initialise this module as one of the streams of a shared JACK client,
+ *  which services all its streams in one process callback. The ports
+ *  are named after the stream, e.g. "synth_input_1". The client must
+ *  have been opened with JackClient::open().
+ *
+ * Auto-reconnect is not available for shared clients.
+ */
+int JackModule::init(JackClient &host,std::string streamName)
+{
+  clientName=streamName;
+  client=host.getClient();
+  if(client == NULL) return 1;
+
+  if(jack_get_buffer_size(client) > MAXBUFFERSIZE) {
+    std::cout << "JACK buffer size larger than " << MAXBUFFERSIZE << std::endl;
+    client=NULL;
+    return -1;
   }
 
-  // Install the callback wrapper and shutdown routine
-  jack_on_shutdown(client,jack_shutdown,0); // install a shutdown callback
-  jack_set_process_callback(client,_wrap_jack_process_cb,this);
+  if(prepareConversion()) {
+    client=NULL;
+    return -1;
+  }
+
+  prepareHistory();
+  portcache.setClient(client);
+  registerPorts(streamName+"_");
+  startStream();
+
+  if(host.addStream(this)) {
+    std::cout << "Too many streams for client " << jack_get_client_name(client) << std::endl;
+    unregisterPorts();
+    client=NULL;
+    state=CLOSED;
+    return -1;
+  }
+  sharedclient=&host;
 
-  char inportname[8]="input_0"; // "input_" + 1-digit number + zero
+  return 0;
+} // init()
 
-  // create an array of -channel- jack_port_t elements
-  input_port = new jack_port_t*[numberOfInputChannels];
+
+/*
+ * Register "input_1", "output_1" etc., preceded by prefix
+ */
+void JackModule::registerPorts(std::string prefix)
+{
   for(int channel=0; channel<numberOfInputChannels; channel++){
-    inportname[6] = channel+0x31;
+    std::ostringstream inportname;
+    inportname << prefix << "input_" << channel+1;
     input_port[channel] =
-      jack_port_register(client,inportname,JACK_DEFAULT_AUDIO_TYPE,JackPortIsInput,0);
+      jack_port_register(client,inportname.str().c_str(),JACK_DEFAULT_AUDIO_TYPE,JackPortIsInput,0);
   }
 
-  char outportname[9]="output_0"; // "output_" + 1-digit number + zero
-
-  // create an array of -channel- jack_port_t elements
-  output_port = new jack_port_t*[numberOfOutputChannels];
   for(int channel=0; channel<numberOfOutputChannels; channel++){
-    outportname[7] = channel+0x31;
+    std::ostringstream outportname;
+    outportname << prefix << "output_" << channel+1;
     output_port[channel] =
-      jack_port_register(client,outportname,JACK_DEFAULT_AUDIO_TYPE,JackPortIsOutput,0);
+      jack_port_register(client,outportname.str().c_str(),JACK_DEFAULT_AUDIO_TYPE,JackPortIsOutput,0);
   }
+} // registerPorts()
 
-  // create buffer arrays of void pointers to prevent memory allocation inside
-  //  the process loop
-  inputbuffer = new jack_default_audio_sample_t*[numberOfInputChannels];
-  outputbuffer = new jack_default_audio_sample_t*[numberOfOutputChannels];
+
+void JackModule::unregisterPorts()
+{
+  for(int channel=0; channel<numberOfInputChannels; channel++) jack_port_unregister(client,input_port[channel]);
+  for(int channel=0; channel<numberOfOutputChannels; channel++) jack_port_unregister(client,output_port[channel]);
+} // unregisterPorts()
+
+
+/*
+ * Everything that's left to do once our ports exist
+ */
+void JackModule::startStream()
+{
+  // end() made them return instead of wait, e.g. before an init() by hand
+  inputringbuffer->abortBlocking(false);
+  outputringbuffer->abortBlocking(false);
+  state=RUNNING;
+  stopping=false;
+} // startStream()
+
+
+/*
+ * Create the history for the current JACK sample rate and channel count,
+ *  before the process callback can use it. A reconnect keeps the history
+ *  it has, as readHistory() may be reading it; every init() starts anew.
+ */
+void JackModule::prepareHistory()
+{
+  if(history != NULL && state != CLOSED) return; // reconnecting
+  delete history;
+  history=NULL;
+  if(historylength > 0){
+    history = new HistoryBuffer(numberOfInputChannels,
+      (unsigned long)(historylength*jack_get_sample_rate(client)));
+  }
+} // prepareHistory()
+
+
+/*
+ * Open the JACK client, register our ports and activate. Used by init()
+ *  and again for every reconnection attempt after a server shutdown.
+ */
+int JackModule::openClient()
+{
+  /*
+   * JackNoStartServer : do not try to start the server
+   * JackNullOption or (jack_options_t)0 to try starting the
+   *   server if it's not already running
+   */
+  if( (client=jack_client_open(clientName.c_str(),JackNoStartServer,NULL)) == 0) {
+    std::cout << "JACK server not running ?" << std::endl;
+    return 1;
+  }
+
+  if(jack_get_buffer_size(client) > MAXBUFFERSIZE) {
+    std::cout << "JACK buffer size larger than " << MAXBUFFERSIZE << std::endl;
+    jack_client_close(client);
+    client=NULL;
+    return -1;
+  }
+
+  if(prepareConversion()) {
+    jack_client_close(client);
+    client=NULL;
+    return -1;
+  }
+
+  jacknode=-1; // JACK's thread may run elsewhere now
+  prepareHistory();
+
+  // Install the callback wrapper and shutdown routine
+  jack_on_shutdown(client,_wrap_jack_shutdown_cb,this);
+  jack_set_process_callback(client,_wrap_jack_process_cb,this);
+  jack_set_sample_rate_callback(client,_wrap_jack_samplerate_cb,this);
+  jack_set_buffer_size_callback(client,_wrap_jack_buffersize_cb,this);
+  jack_set_port_registration_callback(client,_wrap_jack_port_registration_cb,this);
+  portcache.setClient(client);
+
+  registerPorts("");
 
   if(jack_activate(client)) {
     std::cout << "cannot activate client" << std::endl;
+    jack_client_close(client);
+    client=NULL;
     return -1;
   } // if
 
   return 0;
-} // init()
-
-
-
+} // openClient()
 
 
 int JackModule::_wrap_jack_process_cb(jack_nframes_t nframes,void *arg)
@@ -148,6 +327,137 @@ int JackModule::_wrap_jack_process_cb(jack_nframes_t nframes,void *arg)
 } // _wrap_jack_process_cb()
 
 
+void JackModule::_wrap_jack_shutdown_cb(void *arg)
+{
+  ((JackModule *)arg)->onShutdown();
+} // _wrap_jack_shutdown_cb()
+
+
+int JackModule::_wrap_jack_samplerate_cb(jack_nframes_t samplerate,void *arg)
+{
+  return ((JackModule *)arg)->onSamplerate(samplerate);
+} // _wrap_jack_samplerate_cb()
+
+
+int JackModule::_wrap_jack_buffersize_cb(jack_nframes_t nframes,void *arg)
+{
+  return ((JackModule *)arg)->onBuffersize(nframes);
+} // _wrap_jack_buffersize_cb()
+
+
+void JackModule::_wrap_jack_port_registration_cb(jack_port_id_t,int,void *arg)
+{
+  ((JackModule *)arg)->onPortRegistration();
+} // _wrap_jack_port_registration_cb()
+
+
+/*
+ * A port appeared or disappeared somewhere in the graph, so the port
+ *  list for autoConnect() etc. has to be fetched again when needed
+ */
+void JackModule::onPortRegistration()
+{
+  portcache.invalidate();
+} // onPortRegistration()
+
+
+/*
+ * onShutdown() gets called by JACK when the server shuts down or
+ *  disconnects us. The client can't be used anymore, so readSamples()
+ *  and writeSamples() stop blocking and return 0 until we're running
+ *  again, and the supervisor (if any) starts reconnecting.
+ */
+void JackModule::onShutdown()
+{
+  std::lock_guard<std::mutex> lock(statemutex);
+  state=SERVER_LOST;
+  inputringbuffer->abortBlocking(true);
+  outputringbuffer->abortBlocking(true);
+  statechange.notify_all();
+  signalPeriod(); // wake up event loops too
+} // onShutdown()
+
+
+/*
+ * Supervisor thread, only runs with setAutoReconnect(true)
+ *
+ * After a server shutdown it tries to open the client again, with an
+ *  increasing delay between attempts, and restores the connections made
+ *  by autoConnect(). The ringbuffers are kept, so there's nothing to
+ *  allocate and the application can carry on where it was.
+ */
+void JackModule::supervise()
+{
+  std::unique_lock<std::mutex> lock(statemutex);
+
+  while(!stopping){
+    statechange.wait(lock,[this]{ return stopping || state == SERVER_LOST; });
+    if(stopping) break;
+
+    state=RECONNECTING;
+    JackConnections restore=connections;
+    // clientmutex before statemutex, as in the application calls
+    lock.unlock();
+    {
+      std::lock_guard<std::mutex> clientlock(clientmutex);
+      portcache.setClient(NULL); // waits for a lookup that's still going on
+      jack_client_close(client); // after a shutdown it only releases resources
+      client=NULL;
+    }
+
+    unsigned long delay=MINRECONNECTDELAY;
+    while(true){
+      int result;
+      {
+        std::lock_guard<std::mutex> clientlock(clientmutex);
+        result=openClient();
+        if(result == 0) JackPortCache::connect(client,restore,NULL);
+      }
+      lock.lock();
+      if(result == 0 || stopping) break;
+      statechange.wait_for(lock,std::chrono::milliseconds(delay),[this]{ return stopping; });
+      lock.unlock();
+      delay*=2;
+      if(delay > MAXRECONNECTDELAY) delay=MAXRECONNECTDELAY;
+    }
+    if(stopping) break;
+
+    // the new client may have lost the server already, then start over
+    if(state != RECONNECTING) continue;
+    inputringbuffer->abortBlocking(false);
+    outputringbuffer->abortBlocking(false);
+    state=RUNNING;
+    std::cout << "Reconnected to JACK" << std::endl;
+  } // while
+} // supervise()
+
+
+JackModule::State JackModule::getState()
+{
+  return (State)state.load();
+} // getState()
+
+
+/*
+ * With auto-reconnect a server shutdown doesn't end the session, but the
+ *  module keeps trying to reconnect in the background. Call before init().
+ */
+void JackModule::setAutoReconnect(bool reconnect)
+{
+  autoReconnect=reconnect;
+} // setAutoReconnect()
+
+
+/*
+ * Whether a server shutdown is followed by reconnection attempts, which
+ *  is never the case for the streams of a shared client
+ */
+bool JackModule::getAutoReconnect()
+{
+  return autoReconnect && sharedclient == NULL;
+} // getAutoReconnect()
+
+
 /*
  * onProcess() gets called by JACK when it needs samples or has samples available
  *
@@ -175,6 +485,9 @@ int JackModule::onProcess(jack_nframes_t nframes)
    *  - samples are read from the output ringbuffer and written to the output
    */
 
+  JACK_TRACE_SPAN("JackModule::onProcess");
+  if(jacknode < 0) jacknode=BufferAllocator::currentNumaNode(); // once
+
   // for each input port, get a buffer containing samples
   for(int channel=0; channel<numberOfInputChannels; channel++){
     inputbuffer[channel] = (jack_default_audio_sample_t *) jack_port_get_buffer(input_port[channel],nframes);
@@ -185,15 +498,32 @@ int JackModule::onProcess(jack_nframes_t nframes)
     outputbuffer[channel] = (jack_default_audio_sample_t *) jack_port_get_buffer(output_port[channel],nframes);
   }
 
+  // a period that doesn't fit tempbuffer, see onBuffersize()
+  if(nframes > MAXBUFFERSIZE) {
+    for(int channel=0; channel<numberOfOutputChannels; channel++){
+      memset(outputbuffer[channel],0,nframes*sizeof(jack_default_audio_sample_t));
+    }
+    return 0;
+  }
+
+  if(history) {
+    JACK_TRACE_SPAN("history");
+    history->write(inputbuffer,nframes,jack_last_frame_time(client));
+  }
+
+  RateConversion *rates=currentConversion();
+  if(rates && rates->input) {
+    processResampled(rates,nframes);
+    signalPeriod();
+    return 0;
+  }
+
   // push input samples from JACK channel buffers to the input ringbuffer
   // interleave the samples before writing them to the ringbuffer
 
-  int ringbufferindex=0;
-  for(int frame=0; frame<(int)nframes; frame++){
-    for(int channel=0; channel<numberOfInputChannels; channel++){
-      tempbuffer[ringbufferindex]=inputbuffer[channel][frame];
-      ringbufferindex++;
-    }
+  {
+    JACK_TRACE_SPAN("interleave");
+    interleaveInput(tempbuffer,inputbuffer,nframes);
   }
 
   frames_pushed=inputringbuffer->push((jack_default_audio_sample_t *)tempbuffer,nframes*numberOfInputChannels);
@@ -205,20 +535,101 @@ int JackModule::onProcess(jack_nframes_t nframes)
   // appropriate JACK output buffers
 
   frames_popped=outputringbuffer->pop((jack_default_audio_sample_t *)tempbuffer,nframes*numberOfOutputChannels);
-  if(frames_popped<nframes*numberOfOutputChannels) std::cout << "Buffer empty\n";
+  if(frames_popped<nframes*numberOfOutputChannels) {
+    std::cout << "Buffer empty\n";
+    // output silence instead of whatever is left in tempbuffer
+    memset(tempbuffer,0,nframes*numberOfOutputChannels*sizeof(jack_default_audio_sample_t));
+  }
 
-  ringbufferindex=0;
-  for(int frame=0; frame<(int)nframes; frame++){
-    for(int channel=0; channel<numberOfOutputChannels; channel++){
-      outputbuffer[channel][frame]=tempbuffer[ringbufferindex];
-      ringbufferindex++;
-    }
+  {
+    JACK_TRACE_SPAN("deinterleave");
+    deinterleaveOutput(outputbuffer,tempbuffer,nframes);
   }
 
+  signalPeriod();
+
   return 0;
 } // onProcess()
 
 
+/*
+ * onProcess() with conversion between the JACK and application sample
+ *  rates. The input resampler turns a period into however many frames
+ *  it yields; for the output exactly as many frames are taken from the
+ *  ringbuffer as the output resampler needs to fill the period.
+ */
+void JackModule::processResampled(RateConversion *rates,jack_nframes_t nframes)
+{
+  if(numberOfInputChannels > 0){
+    unsigned long n;
+    {
+      JACK_TRACE_SPAN("resample input");
+      n=rates->input->process(inputbuffer,nframes,rates->channels,rates->maxframes);
+    }
+    interleaveInput(rates->interleaved,rates->channels,n);
+    frames_pushed=inputringbuffer->push(rates->interleaved,n*numberOfInputChannels);
+    if(frames_pushed<n*numberOfInputChannels) std::cout << "Buffer full\n";
+  }
+
+  if(numberOfOutputChannels > 0){
+    unsigned long n=rates->output->inputFor(nframes);
+    if(n > rates->maxframes) n=rates->maxframes;
+    frames_popped=outputringbuffer->pop(rates->interleaved,n*numberOfOutputChannels);
+    if(frames_popped<n*numberOfOutputChannels) {
+      std::cout << "Buffer empty\n";
+      memset(rates->interleaved,0,n*numberOfOutputChannels*sizeof(float));
+    }
+    deinterleaveOutput(rates->channels,rates->interleaved,n);
+    JACK_TRACE_SPAN("resample output");
+    unsigned long done=rates->output->process(rates->channels,n,outputbuffer,nframes);
+    if(done < nframes){ // only if n was clamped, which maxframes should rule out
+      for(int channel=0; channel<numberOfOutputChannels; channel++){
+        memset(outputbuffer[channel]+done,0,(nframes-done)*sizeof(float));
+      }
+    }
+  }
+} // processResampled()
+
+
+/*
+ * Interleave nframes frames of numberOfInputChannels separate channels
+ *  into dst. JackModuleT replaces this with code for its fixed number
+ *  of channels.
+ */
+void JackModule::interleaveInput(float *dst,float * const *src,unsigned long nframes)
+{
+  for(unsigned long frame=0; frame<nframes; frame++){
+    for(int channel=0; channel<numberOfInputChannels; channel++){
+      *dst++=src[channel][frame];
+    }
+  }
+} // interleaveInput()
+
+
+void JackModule::deinterleaveOutput(float * const *dst,const float *src,unsigned long nframes)
+{
+  for(unsigned long frame=0; frame<nframes; frame++){
+    for(int channel=0; channel<numberOfOutputChannels; channel++){
+      dst[channel][frame]=*src++;
+    }
+  }
+} // deinterleaveOutput()
+
+
+/*
+ * Tell an event loop waiting on the eventfd that input has arrived and
+ *  output space has become available. A non-blocking write to an
+ *  eventfd doesn't wait, so this is safe in the process callback.
+ */
+void JackModule::signalPeriod()
+{
+  int fd=eventfd.load(std::memory_order_acquire);
+  if(fd < 0) return;
+  uint64_t one=1;
+  if(write(fd,&one,sizeof(one)) < 0) {} // counter full: already signalled
+} // signalPeriod()
+
+
 /*
  * Setting the number of input channels
  */
@@ -242,124 +653,396 @@ int JackModule::setNumberOfOutputChannels(int n)
 }
 
 
+/*
+ * Run the application at a fixed sample rate, whatever the rate of the
+ *  JACK server. readSamples() and writeSamples() then transfer audio at
+ *  this rate and onProcess() resamples at the JACK side of the
+ *  ringbuffers. Call before init().
+ *
+ * Higher qualities use longer filters, which cost more CPU time and add
+ *  more latency, see getInputResamplingLatency(). The history (see
+ *  setHistoryLength()) stays at the JACK rate.
+ */
+int JackModule::setApplicationSamplerate(unsigned long samplerate,Resampler::Quality quality)
+{
+  if(client != NULL) return -1;
+  applicationrate=samplerate;
+  resamplequality=quality;
+  return 0;
+} // setApplicationSamplerate()
+
+
+/*
+ * Build the conversion for the current JACK sample rate, before the
+ *  process callback runs. Returns -1 if the rates can't be converted.
+ */
+int JackModule::prepareConversion()
+{
+  if(applicationrate == 0) return 0;
+  unsigned long jackrate=jack_get_sample_rate(client);
+  RateConversion *current=conversion;
+  if(current != NULL && current->jackrate == jackrate) return 0;
+
+  RateConversion *rates=createConversion(jackrate);
+  if(rates == NULL) {
+    std::cout << "Cannot resample from " << jackrate << " to " << applicationrate << std::endl;
+    return -1;
+  }
+  delete conversion.exchange(rates);
+  return 0;
+} // prepareConversion()
+
+
+/*
+ * Returns NULL if the ratio between the rates is not supported
+ */
+RateConversion *JackModule::createConversion(unsigned long jackrate)
+{
+  RateConversion *rates = new RateConversion;
+  rates->jackrate=jackrate;
+  if(jackrate == applicationrate) {
+    inputlatency=0;
+    outputlatency=0;
+    return rates;
+  }
+
+  int channels = numberOfInputChannels > numberOfOutputChannels ?
+    numberOfInputChannels : numberOfOutputChannels;
+  rates->input = new Resampler(numberOfInputChannels,jackrate,applicationrate,
+    resamplequality,MAXBUFFERSIZE);
+  // a period plus one frame for the fraction, the filter's lookahead (a
+  //  fresh output resampler needs that much on top of the period) and a
+  //  few frames of slack
+  rates->maxframes=(MAXBUFFERSIZE+1)*applicationrate/jackrate+
+    rates->input->getTaps()+4;
+  rates->output = new Resampler(numberOfOutputChannels,applicationrate,jackrate,
+    resamplequality,rates->maxframes);
+  if(!rates->input->isValid() || !rates->output->isValid()) {
+    delete rates;
+    return NULL;
+  }
+  rates->planar = new float[channels*rates->maxframes];
+  for(int channel=0; channel<channels; channel++){
+    rates->channels[channel]=rates->planar+channel*rates->maxframes;
+  }
+  rates->interleaved = new float[channels*rates->maxframes];
+
+  inputlatency=(double)rates->input->getLatency()/jackrate;
+  outputlatency=(double)rates->output->getLatency()/applicationrate;
+  return rates;
+} // createConversion()
+
+
+/*
+ * Called by JACK when the server changes its period. init() only accepts
+ *  periods up to MAXBUFFERSIZE, the size of tempbuffer; a larger one is
+ *  refused, and in case JACK runs it anyway onProcess() outputs silence
+ *  until the period is small enough again.
+ */
+int JackModule::onBuffersize(jack_nframes_t nframes)
+{
+  if(nframes <= MAXBUFFERSIZE) return 0;
+  std::cout << "JACK buffer size larger than " << MAXBUFFERSIZE << ", stream paused" << std::endl;
+  return -1;
+} // onBuffersize()
+
+
+/*
+ * Called by JACK when the server changes its sample rate. The new
+ *  conversion is handed over to onProcess(), which hands back the old
+ *  one to be deleted here next time, so the process callback doesn't
+ *  allocate or free memory.
+ */
+int JackModule::onSamplerate(jack_nframes_t samplerate)
+{
+  if(applicationrate == 0) return 0;
+  delete retiredconversion.exchange(NULL);
+
+  RateConversion *current=conversion;
+  if(current != NULL && current->jackrate == samplerate) return 0;
+
+  RateConversion *rates=createConversion(samplerate);
+  if(rates == NULL) {
+    std::cout << "Cannot resample from " << samplerate << " to " << applicationrate << std::endl;
+    return 0;
+  }
+  delete pendingconversion.exchange(rates);
+  return 0;
+} // onSamplerate()
+
+
+/*
+ * Called by onProcess(): after a sample rate change, switch to the new
+ *  conversion once the one before the current one has been deleted
+ */
+RateConversion *JackModule::currentConversion()
+{
+  if(retiredconversion.load() == NULL){
+    RateConversion *next=pendingconversion.exchange(NULL);
+    if(next != NULL){
+      retiredconversion=conversion.load();
+      conversion=next;
+    }
+  }
+  return conversion;
+} // currentConversion()
+
+
+/*
+ * The application sample rate if one was set, otherwise the JACK rate
+ */
 unsigned long JackModule::getSamplerate()
 {
-  return jack_get_sample_rate(client);
+  if(applicationrate) return applicationrate;
+  return getJackSamplerate();
 } // getSamplerate()
 
 
+/*
+ * This and the other calls that ask the server return 0 while there's
+ *  no client, e.g. during a reconnect
+ */
+unsigned long JackModule::getJackSamplerate()
+{
+  std::lock_guard<std::mutex> lock(clientmutex);
+  if(client == NULL) return 0;
+  return jack_get_sample_rate(client);
+} // getJackSamplerate()
+
+
+/*
+ * Delay added by resampling the input and the output, in seconds.
+ *  Both are 0 if the application runs at the JACK rate.
+ */
+double JackModule::getInputResamplingLatency()
+{
+  return inputlatency;
+} // getInputResamplingLatency()
+
+
+double JackModule::getOutputResamplingLatency()
+{
+  return outputlatency;
+} // getOutputResamplingLatency()
+
+
+unsigned long JackModule::getBuffersize()
+{
+  std::lock_guard<std::mutex> lock(clientmutex);
+  if(client == NULL) return 0;
+  return jack_get_buffer_size(client);
+} // getBuffersize()
+
+
+/*
+ * DSP load of the JACK server as a percentage of the period, which
+ *  includes the time spent in our onProcess()
+ */
+float JackModule::getCpuLoad()
+{
+  std::lock_guard<std::mutex> lock(clientmutex);
+  if(client == NULL) return 0;
+  return jack_cpu_load(client);
+} // getCpuLoad()
+
+
 void JackModule::autoConnect()
 {
   autoConnect("system","system");
 } // autoConnect()
 
 
+/*
+ * Connect our inputs to the outputs of another client and our outputs to
+ *  its inputs. The client names are patterns as for connectInputs(); if
+ *  nothing matches, the ports of "system" are used instead.
+ *
+ * If there are more channels than ports to connect to, the ports are
+ *  used again from the first one. E.g. when connecting 3 input channels
+ *  to 2 source ports, this will look like
+ *
+ *  src1 ---> ch 1
+ *  src2 ---> ch 2
+ *   src1 \-> ch 3
+ *
+ * Likewise, when the source has only one output port:
+ *  src1 ---> ch 1
+ *       \--> ch 2
+ *        \-> ch 3
+ *
+ * For control over which port goes where, use connectInputs() and
+ *  connectOutputs() or mapInputs() and mapOutputs().
+ */
 void JackModule::autoConnect(std::string inputClient, std::string outputClient)
 {
-  /*
-   * Try to auto-connect our input to the output of another client, so we
-   * regard this as an input from our perspective
-   *
-   * To prevent connecting to nonexistent ports, two measures are taken:
-   *  1. if no capture or output ports are found, the internal number
-   *     of channels is set to 0
-   *  2. if the internal number of channels is higher than the number of
-   *  ports they are supposed to connect to, overflow wraps back. E.g. when
-   *  connecting 3 input channels to 2 source ports, this will look like
-   *
-   *  src1 ---> ch 1
-   *  src2 ---> ch 2
-   *   src1 \-> ch 3
-   *
-   * Likewise, when the source has only one output port:
-   *  src1 ---> ch 1
-   *       \--> ch 2
-   *        \-> ch 3
-   */
+JackConnections wanted;
+
+  std::lock_guard<std::mutex> lock(clientmutex);
+  if(client == NULL) return;
 
   if(numberOfInputChannels > 0){
-    ports = jack_get_ports(client,inputClient.c_str(),NULL,JackPortIsOutput);
-    if(ports == NULL) {
+    std::vector<std::string> sources=portcache.find(inputClient,JackPortIsOutput);
+    if(sources.empty() && inputClient != "system") {
       std::cout << "Cannot find capture ports associated with " << inputClient <<
                    ", trying 'system'." << std::endl;
-      // try "system"
-      ports = jack_get_ports(client,"system",NULL,JackPortIsOutput);
-      if(ports == NULL){
-        std::cout << "Cannot find system capture ports. Continuing without inputs." << std::endl;
-	// both attempts failed, continue without capture ports
-        numberOfInputChannels=0;
-      } // if fallback not found
-    } // if specified not found
-
-    // find out the number of (not-null) ports on the source client
-    int nrofinputports=0;
-    while(ports[nrofinputports]) ++nrofinputports;
-    std::cout << "Source client has " << nrofinputports << " ports " << std::endl;
-
-    int inputportindex=0;
-    for(int channel=0; channel<numberOfInputChannels; channel++){
-      std::cout << "connect input channel " << channel << std::endl;
-      if(jack_connect(client,ports[inputportindex],jack_port_name(input_port[channel]))) {
-	std::cout << "Cannot connect input ports" << std::endl;
-      }
-      ++inputportindex;
-      if(nrofinputports>0) inputportindex %= nrofinputports;
-    } // for channel
-
-    free(ports); // ports structure no longer needed
+      sources=portcache.find("system",JackPortIsOutput);
+    }
+    if(sources.empty()) std::cout << "Cannot find capture ports, inputs are not connected." << std::endl;
+    for(int channel=0; channel<numberOfInputChannels && !sources.empty(); channel++){
+      wanted.push_back(std::make_pair(sources[channel%sources.size()],
+        std::string(jack_port_name(input_port[channel]))));
+    }
   }
 
-  /*
-   * Try to auto-connect our output to the input of another client, so we
-   * regard this as an output from our perspective
-   */
   if(numberOfOutputChannels > 0){
-    ports = jack_get_ports(client,outputClient.c_str(),NULL,JackPortIsInput);
-    if(ports == NULL) {
+    std::vector<std::string> destinations=portcache.find(outputClient,JackPortIsInput);
+    if(destinations.empty() && outputClient != "system") {
       std::cout << "Cannot find output ports associated with " << outputClient <<
                    ", trying 'system'." << std::endl;
-      // try "system"
-      ports = jack_get_ports(client,"system",NULL,JackPortIsInput);
-      if(ports == NULL) {
-        std::cout << "Cannot find system output ports. Continuing without outputs." << std::endl;
-	// both attempts failed, continue without output port
-        numberOfOutputChannels=0;
-      } // if fallback not found
-    } // if specified not found
-
-    // find out the number of (not-null) ports on the sink client
-    int nrofoutputports=0;
-    while(ports[nrofoutputports]) ++nrofoutputports;
-    std::cout << "Sink client has " << nrofoutputports << " ports " << std::endl;
-
-    int outputportindex=0;
-    for(int channel=0; channel<numberOfOutputChannels; channel++){
-      std::cout << "connect output channel " << channel << std::endl;
-      if(jack_connect(client,jack_port_name(output_port[outputportindex]),ports[channel]))
-      {
-	std::cout << "Cannot connect output ports" << std::endl;
-      }
-      ++outputportindex;
-      if(nrofoutputports>0) outputportindex %= nrofoutputports;
-    } // for channel
-
-    free(ports); // ports structure no longer needed
+      destinations=portcache.find("system",JackPortIsInput);
+    }
+    if(destinations.empty()) std::cout << "Cannot find output ports, outputs are not connected." << std::endl;
+    for(int channel=0; channel<numberOfOutputChannels && !destinations.empty(); channel++){
+      wanted.push_back(std::make_pair(std::string(jack_port_name(output_port[channel])),
+        destinations[channel%destinations.size()]));
+    }
   }
 
+  applyConnections(wanted);
 } // autoConnect()
 
 
+/*
+ * Connect input channel 1, 2, ... to the first, second, ... output port
+ *  (of any client) whose name matches the pattern, e.g.
+ *
+ *    jack.connectInputs("^system:capture_");
+ *
+ * The pattern is a POSIX extended regular expression that may match any
+ *  part of the full port name, as for jack_get_ports(). Channels without
+ *  a matching port are left alone; there is no wrapping around.
+ *
+ * Returns the number of channels connected, or -1 without a client.
+ */
+int JackModule::connectInputs(std::string pattern)
+{
+  return mapInputs(portcache.find(pattern,JackPortIsOutput));
+} // connectInputs()
+
+
+/*
+ * Connect output channel 1, 2, ... to the first, second, ... input port
+ *  whose name matches the pattern, see connectInputs()
+ */
+int JackModule::connectOutputs(std::string pattern)
+{
+  return mapOutputs(portcache.find(pattern,JackPortIsInput));
+} // connectOutputs()
+
+
+/*
+ * Connect input channel n to the port sources[n], given by its full
+ *  name. An empty name leaves that channel alone, extra names are
+ *  ignored:
+ *
+ *    jack.mapInputs({"system:capture_2","","system:capture_1"});
+ *
+ * Returns the number of channels connected, or -1 without a client.
+ */
+int JackModule::mapInputs(const std::vector<std::string> &sources)
+{
+JackConnections wanted;
+
+  std::lock_guard<std::mutex> lock(clientmutex);
+  if(client == NULL) return -1;
+  for(int channel=0; channel<numberOfInputChannels && channel<(int)sources.size(); channel++){
+    if(sources[channel].empty()) continue;
+    wanted.push_back(std::make_pair(sources[channel],std::string(jack_port_name(input_port[channel]))));
+  }
+  return applyConnections(wanted);
+} // mapInputs()
+
+
+/*
+ * Connect output channel n to the port destinations[n], see mapInputs()
+ */
+int JackModule::mapOutputs(const std::vector<std::string> &destinations)
+{
+JackConnections wanted;
+
+  std::lock_guard<std::mutex> lock(clientmutex);
+  if(client == NULL) return -1;
+  for(int channel=0; channel<numberOfOutputChannels && channel<(int)destinations.size(); channel++){
+    if(destinations[channel].empty()) continue;
+    wanted.push_back(std::make_pair(std::string(jack_port_name(output_port[channel])),destinations[channel]));
+  }
+  return applyConnections(wanted);
+} // mapOutputs()
+
+
+/*
+ * Make the connections all at once and remember them, so they can be
+ *  restored after a reconnect. Returns the number that were made.
+ *  With clientmutex held.
+ */
+int JackModule::applyConnections(const JackConnections &wanted)
+{
+JackConnections made;
+
+  int failed=JackPortCache::connect(client,wanted,&made);
+  if(failed) std::cout << "Cannot make " << failed << " of " << wanted.size() << " connections" << std::endl;
+
+  std::lock_guard<std::mutex> lock(statemutex);
+  for(unsigned int i=0; i<made.size(); i++){
+    bool known=false;
+    for(unsigned int k=0; k<connections.size() && !known; k++) known = connections[k] == made[i];
+    if(!known) connections.push_back(made[i]);
+  }
+  return made.size();
+} // applyConnections()
+
+
 void JackModule::end()
 {
-  jack_deactivate(client);
-  for(int channel=0; channel<numberOfInputChannels; channel++) jack_port_disconnect(client,input_port[channel]);
-  for(int channel=0; channel<numberOfOutputChannels; channel++) jack_port_disconnect(client,output_port[channel]);
+  if(supervisor.joinable()){
+    {
+      std::lock_guard<std::mutex> lock(statemutex);
+      stopping=true;
+      statechange.notify_all();
+    }
+    supervisor.join();
+  }
+
+  if(client == NULL) return; // init() failed or was never called
+  if(sharedclient){
+    // leave the client to the other streams
+    sharedclient->removeStream(this);
+    if(state == RUNNING) unregisterPorts();
+    sharedclient=NULL;
+  }
+  else {
+    if(state == RUNNING){
+      jack_deactivate(client);
+      for(int channel=0; channel<numberOfInputChannels; channel++) jack_port_disconnect(client,input_port[channel]);
+      for(int channel=0; channel<numberOfOutputChannels; channel++) jack_port_disconnect(client,output_port[channel]);
+    }
+    jack_client_close(client);
+  }
+  client=NULL;
+  portcache.setClient(NULL);
+  state=CLOSED;
+
+  // nobody will fill or drain the ringbuffers anymore
+  inputringbuffer->abortBlocking(true);
+  outputringbuffer->abortBlocking(true);
+  signalPeriod();
 } // end()
 
 
 unsigned long JackModule::readSamples(float *ptr,unsigned long nrofsamples)
 {
   // pop samples from JACK inputbuffer and hand over to the caller
+  // if JACK is not running, a call that would have to wait returns 0
   return inputringbuffer->pop(ptr,nrofsamples);
 } // readSamples()
 
@@ -367,16 +1050,335 @@ unsigned long JackModule::readSamples(float *ptr,unsigned long nrofsamples)
 unsigned long JackModule::writeSamples(float *ptr,unsigned long nrofsamples)
 {
   // push samples from the caller to the JACK outputbuffer
+  // if JACK is not running, a call that would have to wait returns 0
   return outputringbuffer->push(ptr,nrofsamples);
 } // readSamples()
 
 
 /*
- * shutdown callback may be called by JACK
+ * Non-blocking versions of readSamples() and writeSamples(): transfer
+ *  all samples or nothing, return the number of samples transferred
+ */
+unsigned long JackModule::tryReadSamples(float *ptr,unsigned long nrofsamples)
+{
+  // we're the only consumer, so the samples can't disappear in between
+  if(inputringbuffer->items_available_for_read() < nrofsamples) return 0;
+  return inputringbuffer->pop(ptr,nrofsamples);
+} // tryReadSamples()
+
+
+unsigned long JackModule::tryWriteSamples(float *ptr,unsigned long nrofsamples)
+{
+  if(outputringbuffer->items_available_for_write() < nrofsamples) return 0;
+  return outputringbuffer->push(ptr,nrofsamples);
+} // tryWriteSamples()
+
+
+/*
+ * readSamples() and writeSamples() for a list of blocks, e.g. one per
+ *  voice or per sub-block, that are transferred as one: one check and
+ *  one update of the ringbuffer for the whole list. The samples of all
+ *  blocks together form the interleaved stream, so block boundaries
+ *  don't need to be on frame boundaries.
+ */
+unsigned long JackModule::readSamplesv(const RingSpan *spans,int nspans)
+{
+  return inputringbuffer->popv(spans,nspans);
+} // readSamplesv()
+
+
+unsigned long JackModule::writeSamplesv(const RingSpan *spans,int nspans)
+{
+  return outputringbuffer->pushv(spans,nspans);
+} // writeSamplesv()
+
+
+/*
+ * Non-blocking versions: all or nothing, or with partial as many
+ *  samples as there are or fit right now
+ */
+unsigned long JackModule::tryReadSamplesv(const RingSpan *spans,int nspans,bool partial)
+{
+  if(!partial){
+    unsigned long n=0;
+    for(int i=0; i<nspans; i++) n+=spans[i].n;
+    if(inputringbuffer->items_available_for_read() < n) return 0;
+  }
+  return inputringbuffer->popv(spans,nspans,partial);
+} // tryReadSamplesv()
+
+
+unsigned long JackModule::tryWriteSamplesv(const RingSpan *spans,int nspans,bool partial)
+{
+  if(!partial){
+    unsigned long n=0;
+    for(int i=0; i<nspans; i++) n+=spans[i].n;
+    if(outputringbuffer->items_available_for_write() < n) return 0;
+  }
+  return outputringbuffer->pushv(spans,nspans,partial);
+} // tryWriteSamplesv()
+
+
+/*
+ * File descriptor that becomes readable once per JACK period, for use
+ *  with poll(), epoll or an event loop (see jack_async.h). Together with
+ *  tryReadSamples() and tryWriteSamples() one thread can serve many
+ *  modules without blocking. Read 8 bytes from it to reset it.
+ *
+ * Returns -1 if no eventfd could be created.
+ */
+int JackModule::getEventFd()
+{
+  int fd=eventfd.load(std::memory_order_acquire);
+  if(fd >= 0) return fd;
+
+  // created on first use, so modules without an event loop don't signal
+  fd=::eventfd(0,EFD_NONBLOCK|EFD_CLOEXEC);
+  if(fd < 0) return -1;
+  int none=-1;
+  if(!eventfd.compare_exchange_strong(none,fd,std::memory_order_acq_rel)) {
+    close(fd); // another thread was first
+    return none;
+  }
+  return fd;
+} // getEventFd()
+
+
+/*
+ * Read overlapping analysis windows, e.g. for an STFT
+ *
+ * The first call reads the first 'window' frames of input, every
+ *  following call moves the window 'hop' frames further. Only the 'hop'
+ *  new frames are read from the input ringbuffer per call, and the
+ *  window stays where it was if they can't be read.
+ *
+ * Returns the window of the first input channel: 'window' contiguous
+ *  samples inside the module, valid until the next call. getWindow()
+ *  gives the other channels. If an analysis window was set with
+ *  setAnalysisWindow(), the samples are multiplied by it.
+ *
+ * Changing the window size starts over with a fresh window.
+ * Returns NULL if no input could be read or hop is larger than window.
+ */
+const float *JackModule::readWindow(unsigned long window,unsigned long hop)
+{
+int channels=numberOfInputChannels;
+
+  if(hop > window || window == 0 || channels == 0) return NULL;
+  if(windowcoefficients != NULL && coefficientslength != window) return NULL;
+
+  if(windowlength == 0 || window != windowlength || channels != windowchannels){
+    delete [] windowhistory;
+    delete [] windowinput;
+    delete [] windowedframe;
+    windowhistory = new float[2*window*channels];
+    windowinput = new float[window*channels];
+    windowedframe = new float[window*channels];
+    windowlength=0;
+    windowchannels=channels;
+    windowpos=0;
+    if(readSamples(windowinput,window*channels) < window*channels) return NULL;
+    windowlength=window;
+    storeWindowInput(0,window);
+  }
+  else {
+    // one read, so a failure leaves the window as it was
+    if(readSamples(windowinput,hop*channels) < hop*channels) return NULL;
+    storeWindowInput(windowpos,hop); // over the oldest 'hop' frames
+    windowpos=(windowpos+hop)%window;
+  }
+
+  windowedchannels=0;
+  return getWindow(0);
+} // readWindow()
+
+
+/*
+ * The window of an input channel, as of the last readWindow(). The
+ *  analysis window is applied the first time a channel is asked for.
+ */
+const float *JackModule::getWindow(int channel)
+{
+  if(windowlength == 0 || channel < 0 || channel >= windowchannels) return NULL;
+  const float *frame=windowhistory+channel*2*windowlength+windowpos;
+  if(windowcoefficients == NULL || coefficientslength != windowlength) return frame;
+
+  float *windowed=windowedframe+channel*windowlength;
+  if(!(windowedchannels & (1U << channel))){
+    for(unsigned long i=0; i<windowlength; i++) windowed[i]=frame[i]*windowcoefficients[i];
+    windowedchannels|=1U << channel;
+  }
+  return windowed;
+} // getWindow()
+
+
+/*
+ * Deinterleave frames from windowinput into the history of each channel.
+ *  Every frame is stored at its position and again one window length
+ *  further, so the latest window is always contiguous from windowpos.
+ */
+void JackModule::storeWindowInput(unsigned long position,unsigned long frames)
+{
+  const float *input=windowinput;
+  for(unsigned long frame=0; frame<frames; frame++){
+    unsigned long index=(position+frame)%windowlength;
+    for(int channel=0; channel<windowchannels; channel++){
+      float *history=windowhistory+channel*2*windowlength;
+      history[index]=history[index+windowlength]=*input++;
+    }
+  }
+} // storeWindowInput()
+
+
+/*
+ * Set the analysis window (e.g. Hann) that readWindow() applies to its
+ *  frames. Pass NULL to switch it off.
+ */
+void JackModule::setAnalysisWindow(const float *coefficients,unsigned long window)
+{
+  delete [] windowcoefficients;
+  windowcoefficients=NULL;
+  windowedchannels=0;
+  if(coefficients == NULL) return;
+
+  coefficientslength=window;
+  windowcoefficients = new float[window];
+  memcpy(windowcoefficients,coefficients,window*sizeof(float));
+} // setAnalysisWindow()
+
+
+/*
+ * Keep the last 'seconds' of input of every channel available for
+ *  readHistory(), independent of the input ringbuffer. Call before init().
  */
-static void jack_shutdown(void *arg)
+void JackModule::setHistoryLength(double seconds)
 {
-  exit(1);
-} // jack_shutdown()
+  historylength=seconds;
+} // setHistoryLength()
 
 
+/*
+ * Copy the input of one channel from JACK frame time start up to (not
+ *  including) end, e.g. the second before a trigger:
+ *
+ *    jack_nframes_t now=jack.getFrameTime();
+ *    jack.readHistory(0,now-samplerate,now,data);
+ *
+ * Returns HISTORY_OK (0) or one of the error codes in history_buffer.h
+ */
+int JackModule::readHistory(int channel,jack_nframes_t start,jack_nframes_t end,float *data)
+{
+  if(history == NULL) return HISTORY_NO_CHANNEL;
+  return history->read(channel,start,end,data);
+} // readHistory()
+
+
+/*
+ * Current JACK frame time, for use with readHistory(). The history ends
+ *  at the start of the current period, so the most recent frames until
+ *  'now' may not be available yet.
+ */
+jack_nframes_t JackModule::getFrameTime()
+{
+  std::lock_guard<std::mutex> lock(clientmutex);
+  if(client == NULL) return 0;
+  return jack_frame_time(client);
+} // getFrameTime()
+
+
+/*
+ * Move a ringbuffer into shared memory, so another process can attach
+ *  to it with RingBuffer::attachShared(shmname) and read the audio input
+ *  (shareInputRing) or supply the audio output (shareOutputRing) without
+ *  an extra copy.
+ *
+ * Call these before init(), afterwards they return -1. The new
+ *  ringbuffer has the same size as the one it replaces; its contents
+ *  are lost.
+ */
+int JackModule::shareInputRing(std::string shmname)
+{
+  if(client != NULL) return -1; // onProcess() uses the current one
+  RingBuffer *shared=RingBuffer::createShared(shmname,inputringbuffer->getSize());
+  if(shared == NULL) return -1;
+  shared->popMayBlock(true);
+  shared->setBlockingNap(500); // usec
+  delete inputringbuffer;
+  inputringbuffer=shared;
+  return 0;
+} // shareInputRing()
+
+
+int JackModule::shareOutputRing(std::string shmname)
+{
+  if(client != NULL) return -1;
+  RingBuffer *shared=RingBuffer::createShared(shmname,outputringbuffer->getSize());
+  if(shared == NULL) return -1;
+  shared->pushMayBlock(true);
+  shared->setBlockingNap(500); // usec
+  delete outputringbuffer;
+  outputringbuffer=shared;
+  return 0;
+} // shareOutputRing()
+
+
+/*
+ * Allocate the ringbuffers and the scratch buffer of onProcess() with
+ *  the given allocator, e.g. on huge pages and locked in memory:
+ *
+ *    BufferAllocator allocator(BufferAllocator::HUGEPAGES|
+ *      BufferAllocator::PREFAULT|BufferAllocator::LOCK);
+ *    jack.setBufferAllocator(&allocator);
+ *
+ * Call before init(). Rings already shared with shareInputRing() or
+ *  shareOutputRing() stay as they are, as replacing them would remove
+ *  the segment the other process uses. The other ringbuffers keep their
+ *  size, their contents are lost. The allocator must outlive the module.
+ */
+int JackModule::setBufferAllocator(BufferAllocator *allocator)
+{
+  if(client != NULL || allocator == NULL) return -1;
+
+  if(!inputringbuffer->isShared()){
+    RingBuffer *input = new RingBuffer(inputringbuffer->getSize(),"in",allocator);
+    input->popMayBlock(true);
+    input->setBlockingNap(500); // usec
+    delete inputringbuffer;
+    inputringbuffer=input;
+  }
+
+  if(!outputringbuffer->isShared()){
+    RingBuffer *output = new RingBuffer(outputringbuffer->getSize(),"out",allocator);
+    output->pushMayBlock(true);
+    output->setBlockingNap(500); // usec
+    delete outputringbuffer;
+    outputringbuffer=output;
+  }
+
+  if(tempbuffer != tempstorage) this->allocator->release(tempbuffer,sizeof(tempstorage));
+  tempbuffer=(jack_default_audio_sample_t *)allocator->allocate(sizeof(tempstorage));
+  this->allocator=allocator;
+  return 0;
+} // setBufferAllocator()
+
+
+/*
+ * Move the ringbuffers, and the scratch buffer if setBufferAllocator()
+ *  allocated it, to the NUMA node of the CPU that runs the process
+ *  callback. Call once audio is running, as the node is only known
+ *  after the first period, and again if JACK's thread may have moved,
+ *  e.g. after a reconnect.
+ *
+ * Returns the node, or -1 if it's not known yet or the pages couldn't
+ *  be moved (e.g. a kernel without NUMA support).
+ */
+int JackModule::moveBuffersToJackNode()
+{
+  int node=jacknode;
+  if(node < 0) return -1;
+  if(inputringbuffer->moveToNode(node) || outputringbuffer->moveToNode(node)) return -1;
+  // tempstorage is part of the module, which may not even be on the heap
+  if(tempbuffer != tempstorage &&
+     BufferAllocator::moveToNode(tempbuffer,sizeof(tempstorage),node)) return -1;
+  return node;
+} // moveBuffersToJackNode()
@@ -30,17 +30,35 @@
 **********************************************************************/
 
 
+#ifndef JACK_MODULE_H
+#define JACK_MODULE_H
+
 #include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <jack/jack.h>
 #include "ringbuffer.h"
+#include "history_buffer.h"
+#include "resampler.h"
+#include "jack_ports.h"
+
+#define MAXINPUTCHANNELS 8
+#define MAXOUTPUTCHANNELS 8
+// largest JACK period onProcess() can handle, sets the size of tempbuffer
+#define MAXBUFFERSIZE 4096
 
-#define MAXINPUTCHANNELS 2
-#define MAXOUTPUTCHANNELS 2
 
+class JackClient;
+struct RateConversion;
 
 class JackModule
 {
+  friend class JackClient; // calls onProcess() and onShutdown()
 public:
+  enum State { CLOSED, RUNNING, SERVER_LOST, RECONNECTING };
   JackModule();
   JackModule(unsigned long inbufsize, unsigned long outbufsize);
   ~JackModule();
@@ -48,27 +66,118 @@ public:
   int setNumberOfOutputChannels(int n);
   int init();
   int init(std::string clientName);
+  int init(JackClient &host,std::string streamName);
+  int setApplicationSamplerate(unsigned long samplerate,
+    Resampler::Quality quality=Resampler::HIGH);
   unsigned long getSamplerate();
+  unsigned long getJackSamplerate();
+  double getInputResamplingLatency();
+  double getOutputResamplingLatency();
+  unsigned long getBuffersize();
+  float getCpuLoad();
   void autoConnect();
   void autoConnect(std::string inputClient,std::string outputClient);
+  int connectInputs(std::string pattern);
+  int connectOutputs(std::string pattern);
+  int mapInputs(const std::vector<std::string> &sources);
+  int mapOutputs(const std::vector<std::string> &destinations);
   unsigned long readSamples(float *,unsigned long);
   unsigned long writeSamples(float *,unsigned long);
+  unsigned long tryReadSamples(float *,unsigned long);
+  unsigned long tryWriteSamples(float *,unsigned long);
+  unsigned long readSamplesv(const RingSpan *spans,int nspans);
+  unsigned long writeSamplesv(const RingSpan *spans,int nspans);
+  unsigned long tryReadSamplesv(const RingSpan *spans,int nspans,bool partial=false);
+  unsigned long tryWriteSamplesv(const RingSpan *spans,int nspans,bool partial=false);
+  int getEventFd();
+  const float *readWindow(unsigned long window,unsigned long hop);
+  const float *getWindow(int channel);
+  void setAnalysisWindow(const float *coefficients,unsigned long window);
+  void setHistoryLength(double seconds);
+  int readHistory(int channel,jack_nframes_t start,jack_nframes_t end,float *data);
+  jack_nframes_t getFrameTime();
+  int shareInputRing(std::string shmname);
+  int shareOutputRing(std::string shmname);
+  int setBufferAllocator(BufferAllocator *allocator);
+  int moveBuffersToJackNode();
+  State getState();
+  void setAutoReconnect(bool reconnect);
+  bool getAutoReconnect();
   void end();
-private:
+protected:
   static int _wrap_jack_process_cb(jack_nframes_t nframes,void *arg);
-  jack_port_t **input_port;
-  jack_port_t **output_port;
-  jack_default_audio_sample_t **inputbuffer;
-  jack_default_audio_sample_t **outputbuffer;
-  jack_default_audio_sample_t tempbuffer[10000]; // FIXME get actual size
-  int onProcess(jack_nframes_t nframes);
+  static void _wrap_jack_shutdown_cb(void *arg);
+  static int _wrap_jack_samplerate_cb(jack_nframes_t samplerate,void *arg);
+  static int _wrap_jack_buffersize_cb(jack_nframes_t nframes,void *arg);
+  static void _wrap_jack_port_registration_cb(jack_port_id_t port,int registered,void *arg);
+  void registerPorts(std::string prefix);
+  void unregisterPorts();
+  void startStream();
+  int openClient();
+  void prepareHistory();
+  void onShutdown();
+  int onSamplerate(jack_nframes_t samplerate);
+  int onBuffersize(jack_nframes_t nframes);
+  void onPortRegistration();
+  int applyConnections(const JackConnections &wanted);
+  int prepareConversion();
+  RateConversion *createConversion(unsigned long jackrate);
+  RateConversion *currentConversion();
+  void processResampled(RateConversion *conversion,jack_nframes_t nframes);
+  virtual void interleaveInput(float *dst,float * const *src,unsigned long nframes);
+  virtual void deinterleaveOutput(float * const *dst,const float *src,unsigned long nframes);
+  void supervise();
+  void signalPeriod();
+  void storeWindowInput(unsigned long position,unsigned long frames);
+  jack_port_t *input_port[MAXINPUTCHANNELS];
+  jack_port_t *output_port[MAXOUTPUTCHANNELS];
+  jack_default_audio_sample_t *inputbuffer[MAXINPUTCHANNELS];
+  jack_default_audio_sample_t *outputbuffer[MAXOUTPUTCHANNELS];
+  jack_default_audio_sample_t tempstorage[MAXBUFFERSIZE*
+    (MAXINPUTCHANNELS > MAXOUTPUTCHANNELS ? MAXINPUTCHANNELS : MAXOUTPUTCHANNELS)];
+  jack_default_audio_sample_t *tempbuffer=tempstorage; // or from allocator
+  BufferAllocator *allocator=NULL; // see setBufferAllocator()
+  std::atomic<int> jacknode; // NUMA node of the process callback, or -1
+  virtual int onProcess(jack_nframes_t nframes);
   int numberOfInputChannels=2;
   int numberOfOutputChannels=2;
   jack_client_t *client;
-  const char **ports;
+  JackClient *sharedclient=NULL; // if we're one of its streams
+  std::string clientName;
+  std::atomic<int> state;
+  bool autoReconnect=false;
+  bool stopping=false;
+  std::thread supervisor; // reconnects after a server shutdown
+  std::mutex statemutex;
+  std::mutex clientmutex; // for client, which the supervisor replaces
+  std::condition_variable statechange;
+  JackConnections connections; // to restore
+  JackPortCache portcache; // for autoConnect() etc.
   RingBuffer *inputringbuffer; // jack writes into
   RingBuffer *outputringbuffer; // jack reads from
+  double historylength=0; // seconds
+  HistoryBuffer *history=NULL; // last historylength seconds of input
+  std::atomic<int> eventfd; // signalled once per period, see getEventFd()
+  // setApplicationSamplerate(): conversion at the ringbuffers
+  unsigned long applicationrate=0; // 0: use the JACK rate
+  Resampler::Quality resamplequality=Resampler::HIGH;
+  std::atomic<RateConversion *> conversion; // used by onProcess()
+  std::atomic<RateConversion *> pendingconversion; // after a rate change
+  std::atomic<RateConversion *> retiredconversion; // to be deleted
+  std::atomic<double> inputlatency; // seconds
+  std::atomic<double> outputlatency;
   unsigned long frames_pushed;
   unsigned long frames_popped;
+  // readWindow(): the last window of each input channel, stored twice in a row
+  float *windowhistory=NULL; // 2*windowlength per channel
+  float *windowinput=NULL; // interleaved, as read from the ringbuffer
+  float *windowcoefficients=NULL;
+  float *windowedframe=NULL; // windowlength per channel
+  unsigned int windowedchannels=0; // bit per channel in windowedframe
+  unsigned long coefficientslength=0;
+  unsigned long windowlength=0; // frames, 0 until the first window is read
+  int windowchannels=0;
+  unsigned long windowpos=0; // oldest frame in windowhistory
 };
 
+#endif
@@ -0,0 +1,107 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : jack_module_t.h
+*  System name   : jack_module
+*
+*  Description   : JackModule with a channel layout that is fixed at
+*		   compile time
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+#ifndef JACK_MODULE_T_H
+#define JACK_MODULE_T_H
+
+#include "jack_module.h"
+#include "interleave.h"
+
+/*
+ * JackModuleT<NumIn,NumOut> behaves like JackModule but the number of
+ *  channels is part of the type, so the (de)interleaving in onProcess()
+ *  is fully unrolled and vectorised, see interleave.h.
+ *
+ * Usage:
+ *
+ *    JackModuleStereo jack;
+ *    jack.init("SuperSynth");
+ *
+ * The channel counts can't be changed, so setNumberOfInputChannels() and
+ *  setNumberOfOutputChannels() are not available. For any layout not
+ *  known at compile time use the plain JackModule.
+ */
+
+template<int NumIn,int NumOut>
+class JackModuleT : public JackModule
+{
+public:
+  JackModuleT();
+  JackModuleT(unsigned long inbufsize, unsigned long outbufsize);
+protected:
+  void interleaveInput(float *dst,float * const *src,unsigned long nframes) override;
+  void deinterleaveOutput(float * const *dst,const float *src,unsigned long nframes) override;
+private:
+  using JackModule::setNumberOfInputChannels;
+  using JackModule::setNumberOfOutputChannels;
+  static_assert(NumIn >= 0 && NumIn <= MAXINPUTCHANNELS,"unsupported number of inputs");
+  static_assert(NumOut >= 0 && NumOut <= MAXOUTPUTCHANNELS,"unsupported number of outputs");
+}; // JackModuleT{}
+
+
+typedef JackModuleT<1,1> JackModuleMono;
+typedef JackModuleT<2,2> JackModuleStereo;
+typedef JackModuleT<6,6> JackModule51;
+typedef JackModuleT<8,8> JackModule71;
+
+
+template<int NumIn,int NumOut>
+JackModuleT<NumIn,NumOut>::JackModuleT() : JackModule()
+{
+  numberOfInputChannels=NumIn;
+  numberOfOutputChannels=NumOut;
+} // JackModuleT()
+
+
+template<int NumIn,int NumOut>
+JackModuleT<NumIn,NumOut>::JackModuleT(unsigned long inbufsize, unsigned long outbufsize) :
+  JackModule(inbufsize,outbufsize)
+{
+  numberOfInputChannels=NumIn;
+  numberOfOutputChannels=NumOut;
+} // JackModuleT()
+
+
+template<int NumIn,int NumOut>
+void JackModuleT<NumIn,NumOut>::interleaveInput(float *dst,float * const *src,unsigned long nframes)
+{
+  Interleaver<NumIn>::interleave(dst,src,nframes);
+} // interleaveInput()
+
+
+template<int NumIn,int NumOut>
+void JackModuleT<NumIn,NumOut>::deinterleaveOutput(float * const *dst,const float *src,unsigned long nframes)
+{
+  Interleaver<NumOut>::deinterleave(dst,src,nframes);
+} // deinterleaveOutput()
+
+#endif
@@ -0,0 +1,149 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : jack_ports.cpp
+*  System name   : jack_module
+*
+*  Description   : port cache class implementation
+*		   Keeps the list of audio ports of the JACK graph, for
+*		    finding ports to connect to without asking the server
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+
+/*
+ * Every jack_get_ports() is a round trip to the server. The cache asks
+ *  for all audio ports at once and keeps the list until the owner calls
+ *  invalidate() from its port registration callback, so looking up the
+ *  ports for many channels, or for the same connections again after a
+ *  graph change, costs one query.
+ *
+ * Patterns are POSIX extended regular expressions that may match any
+ *  part of the full port name, the same as for jack_get_ports(), e.g.
+ *  "system:capture_" or "^mplayer:out_[12]$".
+ */
+
+#include <iostream>
+#include <regex>
+#include <errno.h>
+#include "jack_ports.h"
+
+
+JackPortCache::JackPortCache()
+{
+  client=NULL;
+  valid=false;
+} // JackPortCache()
+
+
+void JackPortCache::setClient(jack_client_t *client)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  this->client=client;
+  valid=false;
+} // setClient()
+
+
+/*
+ * Safe to call from JACK's callbacks: it doesn't wait for anything
+ */
+void JackPortCache::invalidate()
+{
+  valid=false;
+} // invalidate()
+
+
+/*
+ * With the mutex held
+ */
+void JackPortCache::refresh()
+{
+  ports.clear();
+  if(client == NULL) return;
+
+  // set first, so a port registered during the query makes it stale again
+  valid=true;
+  const char **names=jack_get_ports(client,NULL,JACK_DEFAULT_AUDIO_TYPE,0);
+  if(names == NULL) return;
+  for(int i=0; names[i]; i++){
+    jack_port_t *port=jack_port_by_name(client,names[i]);
+    Port entry;
+    entry.name=names[i];
+    entry.flags = port ? jack_port_flags(port) : 0;
+    ports.push_back(entry);
+  }
+  jack_free(names);
+} // refresh()
+
+
+/*
+ * Names of the audio ports that match the pattern and have all the
+ *  given flags (e.g. JackPortIsOutput), in the order JACK lists them.
+ *  An empty pattern matches every port.
+ */
+std::vector<std::string> JackPortCache::find(std::string pattern,unsigned long flags)
+{
+std::vector<std::string> found;
+std::regex expression;
+
+  try {
+    expression=std::regex(pattern,std::regex::extended|std::regex::nosubs);
+  }
+  catch(std::regex_error &error) {
+    std::cout << "Invalid port pattern " << pattern << std::endl;
+    return found;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if(!valid) refresh();
+  for(unsigned int i=0; i<ports.size(); i++){
+    if((ports[i].flags & flags) != flags) continue;
+    if(pattern.empty() || std::regex_search(ports[i].name,expression)) found.push_back(ports[i].name);
+  }
+  return found;
+} // find()
+
+
+/*
+ * Make all connections (source,destination) in one go. Connections that
+ *  already exist count as made. Everything that's in place afterwards is
+ *  added to made, if not NULL.
+ *
+ * Returns the number of connections that failed.
+ */
+int JackPortCache::connect(jack_client_t *client,const JackConnections &connections,
+                           JackConnections *made)
+{
+int failed=0;
+
+  for(unsigned int i=0; i<connections.size(); i++){
+    int result=jack_connect(client,connections[i].first.c_str(),connections[i].second.c_str());
+    if(result == 0 || result == EEXIST) {
+      if(made) made->push_back(connections[i]);
+    }
+    else failed++;
+  }
+  return failed;
+} // connect()
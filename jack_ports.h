@@ -0,0 +1,68 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : jack_ports.h
+*  System name   : jack_module
+*
+*  Description   : port cache class description
+*		   Keeps the list of audio ports of the JACK graph, for
+*		    finding ports to connect to without asking the server
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+#ifndef JACK_PORTS_H
+#define JACK_PORTS_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <jack/jack.h>
+
+typedef std::vector<std::pair<std::string,std::string> > JackConnections;
+
+
+class JackPortCache
+{
+public:
+  JackPortCache();
+  void setClient(jack_client_t *client);
+  void invalidate();
+  std::vector<std::string> find(std::string pattern,unsigned long flags);
+  static int connect(jack_client_t *client,const JackConnections &connections,
+                     JackConnections *made);
+private:
+  struct Port
+  {
+    std::string name;
+    unsigned long flags;
+  };
+  void refresh();
+  jack_client_t *client;
+  std::atomic<bool> valid; // false after a port was (un)registered
+  std::mutex mutex; // for ports
+  std::vector<Port> ports;
+}; // JackPortCache{}
+
+#endif
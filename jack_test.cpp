@@ -33,6 +33,7 @@
 #include <iostream>
 #include <thread>
 #include "jack_module.h"
+#include "jack_trace.h"
 #include "math.h"
 #include "unistd.h"
 
@@ -122,6 +123,8 @@ int main(int argc,char **argv)
 
   jack.end();
 
+  jackTraceDump("jack_test_trace.json"); // only with make TRACE=1
+
   return 0;
 } // main()
 
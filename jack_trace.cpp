@@ -0,0 +1,192 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : jack_trace.cpp
+*  System name   : jack_module
+*
+*  Description   : optional tracing of the audio hot path
+*		   Spans are kept in per-thread rings and can be dumped
+*		    as Chrome trace JSON (chrome://tracing, Perfetto)
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+#include "jack_trace.h"
+
+#ifdef JACK_TRACE
+
+#include <atomic>
+#include <fstream>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+
+
+struct JackTraceEvent
+{
+  const char *name;
+  uint64_t start;
+  uint64_t end;
+};
+
+/*
+ * The rings are static, so a thread's first span doesn't allocate
+ *  memory (which may well happen in the JACK process callback). Pages
+ *  of unused rings are never touched.
+ */
+struct JackTraceRing
+{
+  std::atomic<long> tid; // of the thread that has it, 0 if none
+  std::atomic<unsigned long> count; // #events recorded by that thread
+  JackTraceEvent events[JACK_TRACE_EVENTS];
+};
+
+static JackTraceRing rings[JACK_TRACE_MAXTHREADS];
+static std::atomic<int> nrings(0); // rings ever taken: the dump looks at these
+static thread_local JackTraceRing *threadring=NULL;
+static thread_local bool untraced=false; // no ring was free
+
+
+/*
+ * Take a ring nobody has, or else the ring of a thread that has ended.
+ *  Threads don't hand their ring back when they end, as a pthread key
+ *  destructor would need pthread_setspecific() in the first span, which
+ *  may allocate memory. The spans of an ended thread stay in the dump
+ *  until another thread takes its ring.
+ */
+static JackTraceRing *claimRing()
+{
+  long self=syscall(SYS_gettid);
+  for(int pass=0; pass<2; pass++){
+    for(int index=0; index<JACK_TRACE_MAXTHREADS; index++){
+      JackTraceRing &ring=rings[index];
+      long owner=ring.tid.load();
+      if(pass == 0 && owner != 0) continue;
+      // ESRCH: no thread of this process has that id anymore
+      if(pass == 1 && (syscall(SYS_tgkill,getpid(),owner,0) == 0 || errno != ESRCH)) continue;
+      if(!ring.tid.compare_exchange_strong(owner,self)) continue;
+
+      ring.count.store(0,std::memory_order_release);
+      int n=nrings.load();
+      while(n < index+1 && !nrings.compare_exchange_weak(n,index+1)) {}
+      return &ring;
+    }
+  }
+  return NULL;
+} // claimRing()
+
+
+static uint64_t monotonicNs()
+{
+struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC,&now);
+  return (uint64_t)now.tv_sec*1000000000ULL+now.tv_nsec;
+} // monotonicNs()
+
+
+/*
+ * On x86 the timestamp counter is read directly, that's a few
+ *  nanoseconds. The ticks are converted to time in jackTraceDump().
+ */
+uint64_t jackTraceNow()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return monotonicNs();
+#endif
+} // jackTraceNow()
+
+
+// reference points for converting timestamps to microseconds
+static const uint64_t startticks=jackTraceNow();
+static const uint64_t startns=monotonicNs();
+
+
+void jackTraceRecord(const char *name,uint64_t start,uint64_t end)
+{
+  if(threadring == NULL){
+    if(untraced) return;
+    threadring=claimRing();
+    if(threadring == NULL){
+      untraced=true; // don't search again for every span
+      return;
+    }
+  }
+
+  unsigned long count=threadring->count.load(std::memory_order_relaxed);
+  JackTraceEvent &event=threadring->events[count%JACK_TRACE_EVENTS];
+  event.name=name;
+  event.start=start;
+  event.end=end;
+  threadring->count.store(count+1,std::memory_order_release);
+} // jackTraceRecord()
+
+
+/*
+ * Write the spans in all rings to filename in Chrome trace event
+ *  format. The threads keep recording meanwhile, so a span that's
+ *  overwritten during the dump may come out wrong.
+ *
+ * Returns 0 on success, -1 if the file can't be written.
+ */
+int jackTraceDump(const char *filename)
+{
+std::ofstream out(filename);
+
+  if(!out) return -1;
+
+  // ticks per microsecond, measured over the lifetime of the program
+  double tickspermicrosecond=1000.0;
+  uint64_t nowns=monotonicNs();
+  uint64_t nowticks=jackTraceNow();
+  if(nowns > startns) tickspermicrosecond=(double)(nowticks-startticks)*1000.0/(nowns-startns);
+
+  out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+  bool first=true;
+  int n=nrings.load();
+  for(int r=0; r<n; r++){
+    JackTraceRing &ring=rings[r];
+    unsigned long count=ring.count.load(std::memory_order_acquire);
+    unsigned long oldest = count > JACK_TRACE_EVENTS ? count-JACK_TRACE_EVENTS : 0;
+    for(unsigned long i=oldest; i<count; i++){
+      const JackTraceEvent &event=ring.events[i%JACK_TRACE_EVENTS];
+      if(!first) out << ",";
+      first=false;
+      out << "\n{\"name\": \"" << event.name << "\", \"cat\": \"jack\", \"ph\": \"X\""
+          << ", \"ts\": " << (double)(int64_t)(event.start-startticks)/tickspermicrosecond
+          << ", \"dur\": " << (double)(event.end-event.start)/tickspermicrosecond
+          << ", \"pid\": " << getpid() << ", \"tid\": " << ring.tid.load() << "}";
+    }
+  }
+  out << "\n]}\n";
+
+  return out.good() ? 0 : -1;
+} // jackTraceDump()
+
+#endif
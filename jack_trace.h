@@ -0,0 +1,91 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : jack_trace.h
+*  System name   : jack_module
+*
+*  Description   : optional tracing of the audio hot path
+*		   Spans are kept in per-thread rings and can be dumped
+*		    as Chrome trace JSON (chrome://tracing, Perfetto)
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+#ifndef JACK_TRACE_H
+#define JACK_TRACE_H
+
+/*
+ * Compile with -DJACK_TRACE (make TRACE=1) to enable tracing. Without it
+ *  JACK_TRACE_SPAN() expands to nothing and jackTraceDump() does nothing,
+ *  so there's no cost at all.
+ *
+ *    void work()
+ *    {
+ *      JACK_TRACE_SPAN("work"); // from here to the end of the scope
+ *      ...
+ *    }
+ *
+ *    jackTraceDump("trace.json"); // any time, from any thread
+ *
+ * Span names must be string literals (or otherwise live forever).
+ * Each thread writes into a ring of its own holding the most recent
+ *  JACK_TRACE_EVENTS spans, so recording a span is two timestamp reads
+ *  and one store, without locks or memory allocation. Up to
+ *  JACK_TRACE_MAXTHREADS threads are traced at the same time; once they
+ *  are all taken, a new thread takes the ring of one that has ended.
+ */
+
+#ifdef JACK_TRACE
+
+#include <stdint.h>
+
+#define JACK_TRACE_EVENTS 16384 // per thread, a power of two
+#define JACK_TRACE_MAXTHREADS 64 // at the same time
+
+uint64_t jackTraceNow();
+void jackTraceRecord(const char *name,uint64_t start,uint64_t end);
+int jackTraceDump(const char *filename);
+
+
+class JackTraceSpan
+{
+public:
+  JackTraceSpan(const char *name) : name(name), start(jackTraceNow()) {}
+  ~JackTraceSpan() { jackTraceRecord(name,start,jackTraceNow()); }
+private:
+  const char *name;
+  uint64_t start;
+}; // JackTraceSpan{}
+
+#define JACK_TRACE_CONCAT2(a,b) a##b
+#define JACK_TRACE_CONCAT(a,b) JACK_TRACE_CONCAT2(a,b)
+#define JACK_TRACE_SPAN(name) JackTraceSpan JACK_TRACE_CONCAT(jack_trace_span_,__LINE__)(name)
+
+#else
+
+#define JACK_TRACE_SPAN(name)
+inline int jackTraceDump(const char *) { return -1; }
+
+#endif
+
+#endif
@@ -0,0 +1,249 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : resampler.cpp
+*  System name   : jack_module
+*
+*  Description   : polyphase resampler class implementation
+*		   Converts non-interleaved audio between two fixed
+*		    sample rates with a windowed sinc filter
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+
+/*
+ * The ratio outrate/inrate is reduced to L/M. Conceptually the input is
+ *  upsampled by L, lowpass filtered and every M-th sample is kept. Only
+ *  the samples that are kept are computed: output frame n lies at input
+ *  time n*M/L, so it's the dot product of 'taps' input frames with one
+ *  of the L phases of the filter.
+ *
+ * The filter is a Kaiser windowed sinc with its cutoff just below the
+ *  Nyquist frequency of the lower of both rates. Every phase is scaled
+ *  to unity gain at DC.
+ *
+ * Input frames are collected per channel in a buffer that keeps the
+ *  last 'taps' frames, so process() can be called with any block size
+ *  and output frames come out as soon as all their input is there. That
+ *  takes taps/2 frames of lookahead, which is the latency.
+ */
+
+#include "resampler.h"
+#include <math.h>
+#include <string.h> // memcpy, memmove
+
+// filter length, Kaiser beta and cutoff (fraction of Nyquist) per Quality
+static const int qualitytaps[]={16,32,64,128};
+static const double qualitybeta[]={6.0,8.0,9.5,11.0};
+static const double qualitycutoff[]={0.75,0.86,0.92,0.96};
+
+
+static unsigned long gcd(unsigned long a,unsigned long b)
+{
+  while(b){
+    unsigned long r=a%b;
+    a=b;
+    b=r;
+  }
+  return a;
+} // gcd()
+
+
+// modified Bessel function of the first kind, order 0
+static double besselI0(double x)
+{
+double sum=1.0,term=1.0;
+
+  for(int k=1; k<50; k++){
+    term*=(x/(2*k))*(x/(2*k));
+    sum+=term;
+    if(term < sum*1e-12) break;
+  }
+  return sum;
+} // besselI0()
+
+
+/*
+ * maxinput is the largest number of input frames process() gets at once
+ *
+ * Check isValid() afterwards: ratios that need more than
+ *  RESAMPLER_MAXPHASES phases (e.g. 44100 to 44101) are not supported.
+ */
+Resampler::Resampler(int channels,unsigned long inrate,unsigned long outrate,
+                     Quality quality,unsigned long maxinput)
+{
+  this->channels=channels;
+  taps=qualitytaps[quality];
+  coefficients=NULL;
+  buffer=NULL;
+
+  unsigned long divisor=gcd(inrate,outrate);
+  if(divisor == 0) return;
+  upfactor=outrate/divisor;
+  downfactor=inrate/divisor;
+  if(upfactor > RESAMPLER_MAXPHASES) return;
+
+  // cutoff in cycles per input frame
+  double cutoff=0.5*qualitycutoff[quality];
+  if(upfactor < downfactor) cutoff=cutoff*upfactor/downfactor;
+  double beta=qualitybeta[quality];
+  double half=taps/2;
+
+  coefficients = new float[upfactor*taps];
+  for(unsigned long phase=0; phase<upfactor; phase++){
+    float *h=coefficients+phase*taps;
+    double sum=0;
+    for(int tap=0; tap<taps; tap++){
+      // distance in input frames from this tap to the output frame
+      double t=half-1-tap+(double)phase/upfactor;
+      double x=2*cutoff*t;
+      double sinc = x == 0 ? 1.0 : sin(M_PI*x)/(M_PI*x);
+      double ratio=t/half;
+      double window = ratio*ratio < 1 ? besselI0(beta*sqrt(1-ratio*ratio))/besselI0(beta) : 0;
+      h[tap]=sinc*window;
+      sum+=h[tap];
+    }
+    for(int tap=0; tap<taps; tap++) h[tap]/=sum;
+  }
+
+  capacity=taps+maxinput+downfactor/upfactor+2;
+  buffer = new float[channels*capacity];
+  reset();
+} // Resampler()
+
+
+Resampler::~Resampler()
+{
+  delete [] coefficients;
+  delete [] buffer;
+} // ~Resampler()
+
+
+bool Resampler::isValid()
+{
+  return buffer != NULL;
+} // isValid()
+
+
+/*
+ * Forget all input, as if the resampler was just created
+ */
+void Resampler::reset()
+{
+  if(buffer == NULL) return;
+  // zeros before the first frame, so the first output frame is at time 0
+  memset(buffer,0,channels*capacity*sizeof(float));
+  buffered=taps/2-1;
+  start=0;
+  phase=0;
+} // reset()
+
+
+/*
+ * Sum of taps products. Eight independent partial sums let the compiler
+ *  use SIMD registers without reordering floating point additions, so
+ *  this vectorises without -ffast-math.
+ */
+static inline float dotProduct(const float *x,const float *h,int taps)
+{
+float sum[8]={0,0,0,0,0,0,0,0};
+
+  for(int tap=0; tap<taps; tap+=8){
+    for(int k=0; k<8; k++) sum[k]+=x[tap+k]*h[tap+k];
+  }
+  return ((sum[0]+sum[4])+(sum[1]+sum[5]))+((sum[2]+sum[6])+(sum[3]+sum[7]));
+} // dotProduct()
+
+
+/*
+ * Add ninput frames of every channel and write up to maxoutput frames
+ *  of every channel to output. Returns the number of output frames.
+ *
+ * Input beyond the maxinput given to the constructor is dropped. Input
+ *  that's not needed yet for maxoutput frames is kept for the next call.
+ */
+unsigned long Resampler::process(const float * const *input,unsigned long ninput,
+                                 float * const *output,unsigned long maxoutput)
+{
+  if(buffer == NULL) return 0;
+
+  if(ninput > capacity-buffered) ninput=capacity-buffered;
+  for(int channel=0; channel<channels; channel++){
+    memcpy(buffer+channel*capacity+buffered,input[channel],ninput*sizeof(float));
+  }
+  buffered+=ninput;
+
+  unsigned long noutput=0;
+  while(noutput < maxoutput && start+taps <= buffered){
+    const float *h=coefficients+phase*taps;
+    for(int channel=0; channel<channels; channel++){
+      output[channel][noutput]=dotProduct(buffer+channel*capacity+start,h,taps);
+    }
+    noutput++;
+    phase+=downfactor;
+    start+=phase/upfactor;
+    phase%=upfactor;
+  }
+
+  // drop the frames no output frame needs anymore
+  unsigned long drop = start < buffered ? start : buffered;
+  if(drop > 0){
+    for(int channel=0; channel<channels; channel++){
+      float *data=buffer+channel*capacity;
+      memmove(data,data+drop,(buffered-drop)*sizeof(float));
+    }
+    buffered-=drop;
+    start-=drop;
+  }
+
+  return noutput;
+} // process()
+
+
+/*
+ * Number of input frames process() needs to produce exactly noutput
+ *  frames, e.g. to fill one JACK period from a ringbuffer
+ */
+unsigned long Resampler::inputFor(unsigned long noutput)
+{
+  if(buffer == NULL || noutput == 0) return 0;
+  unsigned long last=start+(phase+(noutput-1)*downfactor)/upfactor;
+  return last+taps > buffered ? last+taps-buffered : 0;
+} // inputFor()
+
+
+/*
+ * Delay added by the resampler, in input frames
+ */
+unsigned long Resampler::getLatency()
+{
+  return taps/2;
+} // getLatency()
+
+
+int Resampler::getTaps()
+{
+  return taps;
+} // getTaps()
@@ -0,0 +1,68 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : resampler.h
+*  System name   : jack_module
+*
+*  Description   : polyphase resampler class description
+*		   Converts non-interleaved audio between two fixed
+*		    sample rates with a windowed sinc filter
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+// ratios between the rates that need more filter phases are not supported
+#define RESAMPLER_MAXPHASES 1024
+
+class Resampler
+{
+public:
+  // filter length 16, 32, 64 or 128 taps
+  enum Quality { FAST, MEDIUM, HIGH, BEST };
+  Resampler(int channels,unsigned long inrate,unsigned long outrate,
+            Quality quality,unsigned long maxinput);
+  ~Resampler();
+  bool isValid();
+  unsigned long process(const float * const *input,unsigned long ninput,
+                        float * const *output,unsigned long maxoutput);
+  unsigned long inputFor(unsigned long noutput);
+  unsigned long getLatency();
+  int getTaps();
+  void reset();
+private:
+  int channels;
+  unsigned long upfactor; // L: phases per input sample
+  unsigned long downfactor; // M: output step in phases
+  int taps; // per phase, a multiple of 8
+  float *coefficients; // phase after phase, taps each
+  unsigned long capacity; // per channel
+  float *buffer; // channel after channel, capacity each
+  unsigned long buffered; // #input frames in buffer
+  unsigned long start; // first tap of the next output frame
+  unsigned long phase; // of the next output frame, 0..upfactor-1
+}; // Resampler{}
+
+#endif
@@ -0,0 +1,128 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : resampler_bench.cpp
+*  System name   : jack_module
+*
+*  Description   : resampler benchmark
+*		   CPU cost of the resampler per channel and quality
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <vector>
+#include <math.h>
+#include <unistd.h>
+#include "resampler.h"
+
+/*
+ * Usage: resampler_bench [outputfile.json]
+ *
+ * Without an argument the JSON result goes to stdout.
+ *
+ * Every configuration resamples SECONDS of noise in periods of PERIOD
+ *  input frames, like the input side of JackModule::onProcess(). The
+ *  cost is given per output frame and channel, and as the fraction of
+ *  one core needed to keep up in real time.
+ */
+
+#define SECONDS 10
+#define PERIOD 256
+#define MAXCHANNELS 8
+
+typedef std::chrono::steady_clock benchclock;
+
+
+static void runConfig(std::ostream &out,unsigned long inrate,unsigned long outrate,
+                      Resampler::Quality quality,int channels,bool first)
+{
+static const char *names[]={"fast","medium","high","best"};
+Resampler resampler(channels,inrate,outrate,quality,PERIOD);
+unsigned long maxoutput=PERIOD*outrate/inrate+2;
+std::vector<float> input(channels*PERIOD);
+std::vector<float> output(channels*maxoutput);
+const float *in[MAXCHANNELS];
+float *outp[MAXCHANNELS];
+unsigned long periods=SECONDS*inrate/PERIOD;
+unsigned long frames=0;
+
+  for(unsigned long i=0; i<input.size(); i++) input[i]=(float)rand()/RAND_MAX-0.5;
+  for(int channel=0; channel<channels; channel++){
+    in[channel]=input.data()+channel*PERIOD;
+    outp[channel]=output.data()+channel*maxoutput;
+  }
+
+  auto start=benchclock::now();
+  for(unsigned long period=0; period<periods; period++){
+    frames+=resampler.process(in,PERIOD,outp,maxoutput);
+  }
+  auto stop=benchclock::now();
+
+  double seconds=std::chrono::duration<double>(stop-start).count();
+
+  if(!first) out << ",\n";
+  out << "    {\"inrate\": " << inrate
+      << ", \"outrate\": " << outrate
+      << ", \"quality\": \"" << names[quality] << "\""
+      << ", \"taps\": " << resampler.getTaps()
+      << ", \"channels\": " << channels
+      << ", \"latency_frames\": " << resampler.getLatency()
+      << ", \"output_frames\": " << frames
+      << ", \"seconds\": " << seconds
+      << ", \"ns_per_frame_channel\": " << seconds*1e9/frames/channels
+      << ", \"realtime_load\": " << seconds/SECONDS
+      << "}";
+} // runConfig()
+
+
+int main(int argc,char **argv)
+{
+unsigned long rates[][2]={{44100,48000},{48000,44100},{96000,48000},{48000,96000}};
+int channelcounts[]={1,2,8};
+std::ofstream outfile;
+bool first=true;
+
+  if(argc > 1) outfile.open(argv[1]);
+  std::ostream &out = (argc > 1) ? outfile : std::cout;
+
+  out << "{\n  \"benchmark\": \"resampler\",\n";
+  out << "  \"period\": " << PERIOD << ",\n";
+  out << "  \"results\": [\n";
+
+  for(auto &rate : rates){
+    for(int quality=Resampler::FAST; quality<=Resampler::BEST; quality++){
+      for(int channels : channelcounts){
+        runConfig(out,rate[0],rate[1],(Resampler::Quality)quality,channels,first);
+        first=false;
+      }
+    }
+  }
+
+  out << "\n  ]\n}\n";
+
+  return 0;
+} // main()
@@ -0,0 +1,151 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : resampler_test.cpp
+*  System name   : jack_module
+*
+*  Description   : resampler test
+*		   Resamples a sine in irregular blocks, both pushed
+*		    (JACK input) and pulled (JACK output), and compares
+*		    the result with the exact sine at the new rate
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+#include <iostream>
+#include <math.h>
+#include "resampler.h"
+
+#define FREQUENCY 1000.0
+#define BLOCK 256
+#define NBLOCKS 200
+
+
+/*
+ * Signal to noise ratio in dB of output frame n at outrate, for both
+ *  channels. The second channel has the opposite sign.
+ */
+class SNR
+{
+public:
+  SNR(unsigned long outrate,unsigned long skip) : outrate(outrate),skip(skip) {}
+  void add(const float *left,const float *right,unsigned long n)
+  {
+    for(unsigned long i=0; i<n; i++,frame++){
+      if(frame < skip) continue;
+      double exact=sin(2*M_PI*FREQUENCY*frame/outrate);
+      signal+=2*exact*exact;
+      noise+=(left[i]-exact)*(left[i]-exact)+(right[i]+exact)*(right[i]+exact);
+    }
+  }
+  double dB() { return 10*log10(signal/noise); }
+  unsigned long frames() { return frame; }
+private:
+  unsigned long outrate;
+  unsigned long skip;
+  unsigned long frame=0;
+  double signal=0,noise=1e-30;
+}; // SNR{}
+
+
+/*
+ * Feed blocks of varying size and take whatever comes out
+ */
+static double pushed(unsigned long inrate,unsigned long outrate,Resampler::Quality quality)
+{
+Resampler resampler(2,inrate,outrate,quality,BLOCK);
+float left[BLOCK],right[BLOCK],outleft[4*BLOCK],outright[4*BLOCK];
+const float *in[2]={left,right};
+float *out[2]={outleft,outright};
+SNR snr(outrate,resampler.getTaps()*outrate/inrate);
+unsigned long frame=0;
+
+  for(int block=0; block<NBLOCKS; block++){
+    unsigned long n=1+(block*97)%BLOCK;
+    for(unsigned long i=0; i<n; i++,frame++){
+      left[i]=sin(2*M_PI*FREQUENCY*frame/inrate);
+      right[i]=-left[i];
+    }
+    unsigned long nout=resampler.process(in,n,out,4*BLOCK);
+    snr.add(outleft,outright,nout);
+  }
+
+  // all input but the lookahead came out
+  unsigned long expected=(frame-resampler.getLatency())*outrate/inrate;
+  if(snr.frames()+1 < expected || snr.frames() > expected+1) return 0;
+  return snr.dB();
+} // pushed()
+
+
+/*
+ * Ask for blocks of varying size and supply exactly the input needed
+ */
+static double pulled(unsigned long inrate,unsigned long outrate,Resampler::Quality quality)
+{
+Resampler resampler(2,inrate,outrate,quality,4*BLOCK);
+float left[4*BLOCK],right[4*BLOCK],outleft[BLOCK],outright[BLOCK];
+const float *in[2]={left,right};
+float *out[2]={outleft,outright};
+SNR snr(outrate,resampler.getTaps()*outrate/inrate);
+unsigned long frame=0;
+
+  for(int block=0; block<NBLOCKS; block++){
+    unsigned long n=1+(block*97)%BLOCK;
+    unsigned long nin=resampler.inputFor(n);
+    for(unsigned long i=0; i<nin; i++,frame++){
+      left[i]=sin(2*M_PI*FREQUENCY*frame/inrate);
+      right[i]=-left[i];
+    }
+    if(resampler.process(in,nin,out,n) != n) return 0;
+    snr.add(outleft,outright,n);
+  }
+
+  return snr.dB();
+} // pulled()
+
+
+int main()
+{
+unsigned long rates[][2]={{44100,48000},{48000,44100},{48000,96000},{96000,44100},{48000,48000}};
+const char *names[]={"fast","medium","high","best"};
+double minimum[]={60,75,90,110}; // dB
+int failures=0;
+
+  for(auto &rate : rates){
+    for(int quality=Resampler::FAST; quality<=Resampler::BEST; quality++){
+      double push=pushed(rate[0],rate[1],(Resampler::Quality)quality);
+      double pull=pulled(rate[0],rate[1],(Resampler::Quality)quality);
+      bool ok = push >= minimum[quality] && pull >= minimum[quality];
+      if(!ok) failures++;
+      std::cout << rate[0] << " -> " << rate[1] << " " << names[quality] <<
+        ": " << push << " dB pushed, " << pull << " dB pulled" <<
+        (ok ? "" : " FAILED") << std::endl;
+    }
+  }
+
+  Resampler unsupported(1,44100,44101,Resampler::FAST,BLOCK);
+  if(unsupported.isValid()) failures++;
+
+  return failures ? 1 : 0;
+} // main()
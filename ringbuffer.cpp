@@ -49,47 +49,235 @@
 
 #include <iostream>
 #include "ringbuffer.h"
+#include "jack_trace.h"
+#include <new> // placement new
+#include <stdlib.h> // posix_memalign
 #include <unistd.h>
 #include <string.h> // memcpy
+#include <errno.h>
+#include <signal.h> // kill
+#include <fcntl.h> // O_* constants
+#include <sys/mman.h> // shm_open, mmap
+#include <sys/stat.h>
 
 
  /*
   * Size is specified as #items, not bytes. Item type is now float and will
   * eventually be set in template form
+  *
+  * With an allocator, e.g. for huge pages, the data comes from there.
+  * The allocator must outlive the ringbuffer.
   */
-RingBuffer::RingBuffer(unsigned long size,std::string name)
+RingBuffer::RingBuffer(unsigned long size,std::string name,BufferAllocator *allocator)
 {
-  tail=0; // write pointer
-  head=0; // read pointer
+void *memory=NULL;
+
+  // the header is aligned to keep head and tail on separate cache lines
+  if(posix_memalign(&memory,64,sizeof(RingBufferHeader)) != 0) throw std::bad_alloc();
+  header = new(memory) RingBufferHeader;
+  header->version=RINGBUFFER_SHM_VERSION;
+  header->indexsize=sizeof(unsigned long);
+  header->itemsize=sizeof(float);
+  header->size=size;
+  header->dataoffset=0; // not used for the heap version
+  header->peers=0;
+  header->creator=getpid();
+  header->tail=0; // write pointer
+  header->head=0; // read pointer
+  header->magic=RINGBUFFER_SHM_MAGIC;
   this->size=size;
   itemsize=sizeof(float);
-  buffer = new float [size]; // allocate storage
+  this->allocator=allocator;
+  if(allocator) buffer=(float *)allocator->allocate(size*sizeof(float));
+  else buffer = new float [size]; // allocate storage
   this->name=name;
   // some defaults
   blockingPush=false;
   blockingPop=false;
   blockingNap=500;
+  aborted=false;
+} // RingBuffer()
+
+
+/*
+ * Used by createShared() and attachShared(): the header and the data
+ *  are in one shared memory mapping
+ */
+RingBuffer::RingBuffer(RingBufferHeader *header,unsigned long mappedsize,std::string shmname,bool owner)
+{
+  this->header=header;
+  this->mappedsize=mappedsize;
+  shmowner=owner;
+  size=header->size;
+  itemsize=sizeof(float);
+  buffer=(float *)((char *)header+header->dataoffset);
+  name=shmname;
+  blockingPush=false;
+  blockingPop=false;
+  blockingNap=500;
+  aborted=false;
 } // RingBuffer()
 
 
 RingBuffer::~RingBuffer()
 {
-  delete [] buffer;
+  if(mappedsize > 0){
+    header->peers--;
+    munmap(header,mappedsize);
+    if(shmowner) shm_unlink(name.c_str());
+  }
+  else {
+    if(allocator) allocator->release(buffer,size*sizeof(float));
+    else delete [] buffer;
+    header->~RingBufferHeader();
+    free(header);
+  }
 } // ~RingBuffer()
 
 
+/*
+ * Create a ringbuffer in a POSIX shared memory segment so a producer or
+ *  consumer in another process can attach to it with attachShared().
+ *
+ * shmname follows the shm_open() convention, e.g. "/supersynth_out".
+ * The segment is removed when this ringbuffer is destroyed.
+ *
+ * A segment with this name that was left behind by a process that no
+ *  longer runs, e.g. a host that crashed, is replaced. Peers that were
+ *  attached to the old one have to attach again. If the process that
+ *  made the segment still runs, this fails.
+ * Returns NULL on failure.
+ */
+RingBuffer *RingBuffer::createShared(std::string shmname,unsigned long size)
+{
+  // data starts at the first cache line after the header
+  unsigned long dataoffset=(sizeof(RingBufferHeader)+63) & ~63UL;
+  unsigned long mappedsize=dataoffset+size*sizeof(float);
+
+  int fd=shm_open(shmname.c_str(),O_CREAT|O_EXCL|O_RDWR,0600);
+  if(fd < 0 && errno == EEXIST && removeStale(shmname)) {
+    fd=shm_open(shmname.c_str(),O_CREAT|O_EXCL|O_RDWR,0600);
+  }
+  if(fd < 0) {
+    std::cout << "Cannot create shared memory " << shmname << std::endl;
+    return NULL;
+  }
+  if(ftruncate(fd,mappedsize) != 0) {
+    close(fd);
+    shm_unlink(shmname.c_str());
+    return NULL;
+  }
+  void *memory=mmap(NULL,mappedsize,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+  close(fd); // the mapping stays valid
+  if(memory == MAP_FAILED) {
+    shm_unlink(shmname.c_str());
+    return NULL;
+  }
+
+  RingBufferHeader *header = new(memory) RingBufferHeader;
+  header->version=RINGBUFFER_SHM_VERSION;
+  header->indexsize=sizeof(unsigned long);
+  header->itemsize=sizeof(float);
+  header->size=size;
+  header->dataoffset=dataoffset;
+  header->peers=1;
+  header->creator=getpid();
+  header->tail=0;
+  header->head=0;
+  // publish: attachShared() doesn't accept the segment before this
+  header->magic.store(RINGBUFFER_SHM_MAGIC,std::memory_order_release);
+
+  return new RingBuffer(header,mappedsize,shmname,true);
+} // createShared()
+
+
+/*
+ * Unlink the segment shmname only if it's a published ringbuffer of this
+ *  version and the process that made it is gone. Anything else may be
+ *  in use: a creator that hasn't published its header yet, or a segment
+ *  that isn't ours at all. Returns true if it was removed.
+ */
+bool RingBuffer::removeStale(std::string shmname)
+{
+struct stat shmstat;
+bool stale=false;
+
+  int fd=shm_open(shmname.c_str(),O_RDONLY,0);
+  if(fd < 0) return false;
+  if(fstat(fd,&shmstat) == 0 && (unsigned long)shmstat.st_size >= sizeof(RingBufferHeader)) {
+    void *memory=mmap(NULL,sizeof(RingBufferHeader),PROT_READ,MAP_SHARED,fd,0);
+    if(memory != MAP_FAILED) {
+      RingBufferHeader *header=(RingBufferHeader *)memory;
+      if(header->magic.load(std::memory_order_acquire) == RINGBUFFER_SHM_MAGIC &&
+         header->version == RINGBUFFER_SHM_VERSION) {
+        // EPERM: it exists but belongs to someone else
+        stale = kill(header->creator,0) != 0 && errno == ESRCH;
+      }
+      munmap(memory,sizeof(RingBufferHeader));
+    }
+  }
+  close(fd);
+
+  if(!stale) return false;
+  std::cout << "Removing stale shared memory " << shmname << std::endl;
+  return shm_unlink(shmname.c_str()) == 0;
+} // removeStale()
+
+
+/*
+ * Attach to a ringbuffer made by createShared() in another process.
+ *
+ * Returns NULL if the segment doesn't exist (yet), isn't initialised
+ *  yet or has an incompatible layout. In the first two cases trying
+ *  again later makes sense.
+ */
+RingBuffer *RingBuffer::attachShared(std::string shmname)
+{
+struct stat shmstat;
+
+  int fd=shm_open(shmname.c_str(),O_RDWR,0);
+  if(fd < 0) return NULL;
+  if(fstat(fd,&shmstat) != 0 || (unsigned long)shmstat.st_size < sizeof(RingBufferHeader)) {
+    close(fd);
+    return NULL;
+  }
+  unsigned long mappedsize=shmstat.st_size;
+  void *memory=mmap(NULL,mappedsize,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+  close(fd);
+  if(memory == MAP_FAILED) return NULL;
+
+  RingBufferHeader *header=(RingBufferHeader *)memory;
+  if(header->magic.load(std::memory_order_acquire) != RINGBUFFER_SHM_MAGIC ||
+     header->version != RINGBUFFER_SHM_VERSION ||
+     header->indexsize != sizeof(unsigned long) ||
+     header->itemsize != sizeof(float) ||
+     header->dataoffset+header->size*sizeof(float) > mappedsize) {
+    std::cout << "Shared memory " << shmname << " is not a compatible ringbuffer" << std::endl;
+    munmap(memory,mappedsize);
+    return NULL;
+  }
+  header->peers++;
+
+  return new RingBuffer(header,mappedsize,shmname,false);
+} // attachShared()
+
+
 unsigned long RingBuffer::items_available_for_write()
 {
-long pointerspace=(long)head.load()-(long)tail.load(); // signed
+long pointerspace=(long)header->head.load()-(long)header->tail.load(); // signed
 
-  if(pointerspace > 0) return pointerspace; // NB: > 0 so NOT including 0
-  else return (unsigned long) (pointerspace+size);
+  /*
+   * One slot always stays empty: a completely filled buffer would have
+   *  tail == head, which is indistinguishable from an empty one
+   */
+  if(pointerspace > 0) return pointerspace-1; // NB: > 0 so NOT including 0
+  else return (unsigned long) (pointerspace+size-1);
 } // items_available_for_write()
 
 
 unsigned long RingBuffer::items_available_for_read()
 {
-long pointerspace=(long)tail.load()-(long)head.load(); // signed
+long pointerspace=(long)header->tail.load()-(long)header->head.load(); // signed
 
   if(pointerspace >= 0) return pointerspace; // NB: >= 0 so including 0
   else return (unsigned long) (pointerspace+size);
@@ -114,31 +302,38 @@ void RingBuffer::setBlockingNap(unsigned long blockingNap)
 } // setBlockingNap()
 
 
+/*
+ * While aborted, blocking push() and pop() calls don't wait for space or
+ *  data but return 0 instead. This also wakes up callers that are
+ *  already waiting, within one blocking nap.
+ */
+void RingBuffer::abortBlocking(bool abort)
+{
+  aborted=abort;
+} // abortBlocking()
+
+
 /*
  * Try to write as many items as possible and return the number actually written
  */
 unsigned long RingBuffer::push(float *data,unsigned long n)
 {
+  JACK_TRACE_SPAN("RingBuffer::push");
   unsigned long space=items_available_for_write();
 
-  if(blockingPush){
+  if(blockingPush && space<n){
+    JACK_TRACE_SPAN("RingBuffer::push wait");
     // block and keep re-assessing available space
     while((space=items_available_for_write())<n){
+      if(aborted) return 0;
       usleep(blockingNap);
     } // while
   } // if
   if(space<n) return 0; // reject partial chunks
 
-  const auto current_tail = tail.load();
-  if(current_tail + n <= (unsigned long)size){ // chunk fits without wrapping
-    memcpy(buffer+current_tail,data,n*itemsize);
-  }
-  else {
-    unsigned long first_chunk=size-current_tail;
-    memcpy(buffer+current_tail,data,first_chunk*itemsize);
-    memcpy(buffer,data+first_chunk,(n-first_chunk)*itemsize);
-  }
-  tail.store((current_tail+n)%size);
+  const auto current_tail = header->tail.load();
+  copyIn(current_tail,data,n);
+  header->tail.store((current_tail+n)%size);
   return n;
 } // push()
 
@@ -147,32 +342,200 @@ unsigned long RingBuffer::push(float *data,unsigned long n)
  * Try to read as many items as possible and return the number actually read
  */
 unsigned long RingBuffer::pop(float *data,unsigned long n)
+{
+  JACK_TRACE_SPAN("RingBuffer::pop");
+  if(n == 0 || peek(data,n) < n) return 0;
+
+  // only the consumer moves head, so it's still where peek() found it
+  header->head.store((header->head.load()+n)%size);
+  return n;
+} // pop()
+
+
+/*
+ * Like pop() but the items stay in the buffer: the next peek() or pop()
+ *  returns them again. Together with advance() this lets a consumer read
+ *  overlapping blocks, e.g. analysis windows with a hop size smaller
+ *  than the window.
+ */
+unsigned long RingBuffer::peek(float *data,unsigned long n)
 {
   unsigned long space=items_available_for_read();
 
-  if(blockingPop){
+  if(blockingPop && space<n){
+    JACK_TRACE_SPAN("RingBuffer::pop wait");
     while((space=items_available_for_read())<n){ // blocking
+      if(aborted) return 0;
       usleep(blockingNap);
     } // while
   } // if
   if(space<n) return 0; // reject partial chunks
 
-  const auto current_head = head.load();
-  if(current_head + n <= (unsigned long)size){ // no wrapping necessary
-    memcpy(data,buffer+current_head,n*itemsize);
+  copyOut(header->head.load(),data,n);
+  return n;
+} // peek()
+
+
+/*
+ * Write a list of blocks, e.g. one per voice, as if they were one chunk:
+ *  one check for space and one update of the write pointer for all of
+ *  them, so the consumer sees the whole batch at once.
+ *
+ * Blocks like push() and takes all or nothing, unless partial is set:
+ *  then it never blocks and takes as many items as there's space for,
+ *  the last block that fits partly being cut off.
+ *
+ * Returns the number of items written
+ */
+unsigned long RingBuffer::pushv(const RingSpan *spans,int nspans,bool partial)
+{
+  JACK_TRACE_SPAN("RingBuffer::pushv");
+  unsigned long n=0;
+  for(int i=0; i<nspans; i++) n+=spans[i].n;
+  unsigned long space=items_available_for_write();
+
+  if(partial) {
+    if(space<n) n=space;
+  }
+  else if(blockingPush && space<n){
+    JACK_TRACE_SPAN("RingBuffer::push wait");
+    while((space=items_available_for_write())<n){
+      if(aborted) return 0;
+      usleep(blockingNap);
+    } // while
+  } // if
+  if(space<n || n == 0) return 0;
+
+  const auto current_tail = header->tail.load();
+  unsigned long position=current_tail;
+  unsigned long left=n;
+  for(int i=0; i<nspans && left>0; i++){
+    unsigned long count = spans[i].n < left ? spans[i].n : left;
+    copyIn(position,spans[i].data,count);
+    position=(position+count)%size;
+    left-=count;
+  }
+  header->tail.store((current_tail+n)%size);
+  return n;
+} // pushv()
+
+
+/*
+ * Read into a list of blocks with one check for data and one update of
+ *  the read pointer. Like pushv(), all or nothing unless partial is set,
+ *  then it never blocks and fills the blocks with what's available.
+ *
+ * Returns the number of items read
+ */
+unsigned long RingBuffer::popv(const RingSpan *spans,int nspans,bool partial)
+{
+  JACK_TRACE_SPAN("RingBuffer::popv");
+  unsigned long n=0;
+  for(int i=0; i<nspans; i++) n+=spans[i].n;
+  unsigned long space=items_available_for_read();
+
+  if(partial) {
+    if(space<n) n=space;
+  }
+  else if(blockingPop && space<n){
+    JACK_TRACE_SPAN("RingBuffer::pop wait");
+    while((space=items_available_for_read())<n){
+      if(aborted) return 0;
+      usleep(blockingNap);
+    } // while
+  } // if
+  if(space<n || n == 0) return 0;
+
+  const auto current_head = header->head.load();
+  unsigned long position=current_head;
+  unsigned long left=n;
+  for(int i=0; i<nspans && left>0; i++){
+    unsigned long count = spans[i].n < left ? spans[i].n : left;
+    copyOut(position,spans[i].data,count);
+    position=(position+count)%size;
+    left-=count;
+  }
+  header->head.store((current_head+n)%size);
+  return n;
+} // popv()
+
+
+/*
+ * Copy n items into the buffer from position on, wrapping if needed
+ */
+void RingBuffer::copyIn(unsigned long position,const float *data,unsigned long n)
+{
+  if(position + n <= size){ // chunk fits without wrapping
+    memcpy(buffer+position,data,n*itemsize);
   }
   else {
-    unsigned long first_chunk=size-current_head;
-    memcpy(data,buffer+current_head,first_chunk*itemsize);
+    unsigned long first_chunk=size-position;
+    memcpy(buffer+position,data,first_chunk*itemsize);
+    memcpy(buffer,data+first_chunk,(n-first_chunk)*itemsize);
+  }
+} // copyIn()
+
+
+void RingBuffer::copyOut(unsigned long position,float *data,unsigned long n)
+{
+  if(position + n <= size){ // no wrapping necessary
+    memcpy(data,buffer+position,n*itemsize);
+  }
+  else {
+    unsigned long first_chunk=size-position;
+    memcpy(data,buffer+position,first_chunk*itemsize);
     memcpy(data+first_chunk,buffer,(n-first_chunk)*itemsize);
   }
-  head.store((current_head+n)%size);
+} // copyOut()
+
+
+/*
+ * Discard n items without copying them. Never blocks: returns 0 if
+ *  fewer than n items are available.
+ */
+unsigned long RingBuffer::advance(unsigned long n)
+{
+  if(items_available_for_read() < n) return 0;
+
+  header->head.store((header->head.load()+n)%size);
   return n;
-} // pop()
+} // advance()
 
 
 bool RingBuffer::isLockFree()
 {
-  return (tail.is_lock_free() && head.is_lock_free());
+  return (header->tail.is_lock_free() && header->head.is_lock_free());
 } // isLockFree()
 
+
+unsigned long RingBuffer::getSize()
+{
+  return size;
+} // getSize()
+
+
+bool RingBuffer::isShared()
+{
+  return mappedsize > 0;
+} // isShared()
+
+
+/*
+ * Number of processes using a shared ringbuffer, including this one
+ */
+unsigned int RingBuffer::getPeers()
+{
+  return header->peers.load();
+} // getPeers()
+
+
+/*
+ * Move the control block and data to the given NUMA node, e.g. the node
+ *  of the CPU that runs the audio callback. Returns 0 on success.
+ */
+int RingBuffer::moveToNode(int numanode)
+{
+  if(BufferAllocator::moveToNode(buffer,size*sizeof(float),numanode)) return -1;
+  return BufferAllocator::moveToNode(header,sizeof(RingBufferHeader),numanode);
+} // moveToNode()
+
@@ -37,31 +37,90 @@
  * ringbuffer.h
  */
 
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
 #include <atomic>
 #include <string>
+#include <stdint.h>
+#include "buffer_allocator.h"
+
+#define RINGBUFFER_SHM_MAGIC 0x52696e67 // "Ring"
+#define RINGBUFFER_SHM_VERSION 2
+
+/*
+ * Control block of a ringbuffer. For a ringbuffer in shared memory this
+ *  is placed at the start of the segment, followed by the sample data at
+ *  dataoffset. It contains no pointers, so every process can map the
+ *  segment at a different address.
+ */
+struct RingBufferHeader
+{
+  std::atomic<uint32_t> magic; // set last by the creator
+  uint32_t version;
+  uint32_t indexsize; // sizeof(unsigned long) of the creator
+  uint32_t itemsize;
+  unsigned long size; // #items
+  unsigned long dataoffset; // bytes from the start of the header
+  std::atomic<uint32_t> peers; // number of attached processes
+  int32_t creator; // pid of the process that made the segment
+  alignas(64) std::atomic<unsigned long> tail; // write pointer
+  alignas(64) std::atomic<unsigned long> head; // read pointer
+}; // RingBufferHeader{}
+
+
+/*
+ * One block of items for pushv() and popv()
+ */
+struct RingSpan
+{
+  float *data;
+  unsigned long n;
+}; // RingSpan{}
+
 
 class RingBuffer
 {
 public:
-  RingBuffer(unsigned long size,std::string name);
+  RingBuffer(unsigned long size,std::string name,BufferAllocator *allocator=NULL);
   ~RingBuffer();
+  static RingBuffer *createShared(std::string shmname,unsigned long size);
+  static RingBuffer *attachShared(std::string shmname);
   unsigned long push(float *data,unsigned long n);
   unsigned long pop(float *data,unsigned long n);
+  unsigned long pushv(const RingSpan *spans,int nspans,bool partial=false);
+  unsigned long popv(const RingSpan *spans,int nspans,bool partial=false);
+  unsigned long peek(float *data,unsigned long n);
+  unsigned long advance(unsigned long n);
   unsigned long items_available_for_write();
   unsigned long items_available_for_read();
+  unsigned long getSize();
   bool isLockFree();
+  bool isShared();
+  unsigned int getPeers();
+  int moveToNode(int numanode);
   void pushMayBlock(bool block);
   void popMayBlock(bool block);
   void setBlockingNap(unsigned long blockingNap);
+  void abortBlocking(bool abort);
 private:
+  RingBuffer(RingBufferHeader *header,unsigned long mappedsize,std::string shmname,bool owner);
+  static bool removeStale(std::string shmname);
+  void copyIn(unsigned long position,const float *data,unsigned long n);
+  void copyOut(unsigned long position,float *data,unsigned long n);
+  RingBufferHeader *header;
   unsigned long size;
   float *buffer;
-  std::atomic<unsigned long> tail; // write pointer
-  std::atomic<unsigned long> head; // read pointer
   unsigned long itemsize; // also depends on #channels
   std::string name;
   bool blockingPush;
   bool blockingPop;
   unsigned long blockingNap=500;
+  std::atomic<bool> aborted; // makes blocking calls give up
+  BufferAllocator *allocator=NULL; // NULL: buffer from new[]
+  // shared memory only
+  unsigned long mappedsize=0; // 0 if on the heap
+  bool shmowner=false; // unlink the segment when done
 }; // RingBuffer{}
 
+#endif
@@ -0,0 +1,273 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : ringbuffer_bench.cpp
+*  System name   : jack_module
+*
+*  Description   : ring buffer benchmark
+*		   SPSC throughput and push-to-pop latency percentiles
+*		    for a range of buffer sizes, chunk sizes and thread
+*		    placements. Results are written as JSON.
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+#include "ringbuffer.h"
+
+/*
+ * Usage: ringbuffer_bench [outputfile.json]
+ *
+ * Without an argument the JSON result goes to stdout.
+ *
+ * Every configuration moves TOTALITEMS items from a producer thread to a
+ * consumer thread in fixed chunks. The producer timestamps each chunk
+ * just before pushing it and the consumer timestamps it right after
+ * popping it, so the latency includes time spent waiting for space or
+ * data in blocking mode.
+ */
+
+#define TOTALITEMS (1UL<<21)
+
+typedef std::chrono::steady_clock benchclock;
+
+enum Pinning { PIN_NONE, PIN_SAME_CORE, PIN_SPLIT_CORES };
+
+static const char *pinningName(Pinning pinning)
+{
+  switch(pinning){
+    case PIN_SAME_CORE: return "same_core";
+    case PIN_SPLIT_CORES: return "split_cores";
+    default: return "none";
+  }
+} // pinningName()
+
+
+/*
+ * Pin the calling thread to a cpu, -1 leaves it to the scheduler. Called
+ *  first thing in the thread body, so no item moves before it's pinned.
+ */
+static void pinThread(int cpu)
+{
+cpu_set_t cpuset;
+
+  if(cpu < 0) return;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu,&cpuset);
+  pthread_setaffinity_np(pthread_self(),sizeof(cpu_set_t),&cpuset);
+} // pinThread()
+
+
+static long long percentile(const std::vector<long long> &sorted,double p)
+{
+  if(sorted.empty()) return 0;
+  unsigned long index=(unsigned long)(p*(sorted.size()-1));
+  return sorted[index];
+} // percentile()
+
+
+/*
+ * Run one configuration and write its JSON object to out
+ */
+static void runConfig(std::ostream &out,unsigned long size,unsigned long chunk,
+                      Pinning pinning,unsigned long nap,bool first)
+{
+RingBuffer ringbuffer(size,"bench");
+unsigned long nchunks=TOTALITEMS/chunk;
+std::vector<benchclock::time_point> pushtime(nchunks);
+std::vector<benchclock::time_point> poptime(nchunks);
+int ncpus=(int)sysconf(_SC_NPROCESSORS_ONLN);
+int producercpu=-1,consumercpu=-1;
+
+  ringbuffer.pushMayBlock(true);
+  ringbuffer.popMayBlock(true);
+  ringbuffer.setBlockingNap(nap);
+
+  if(pinning == PIN_SAME_CORE){
+    producercpu=0;
+    consumercpu=0;
+  }
+  else if(pinning == PIN_SPLIT_CORES){
+    producercpu=0;
+    consumercpu=ncpus>1 ? 1 : 0;
+  }
+
+  auto start=benchclock::now();
+
+  std::thread producer([&](){
+    pinThread(producercpu);
+    std::vector<float> data(chunk,0.5);
+    for(unsigned long i=0; i<nchunks; i++){
+      pushtime[i]=benchclock::now();
+      ringbuffer.push(data.data(),chunk);
+    }
+  });
+
+  std::thread consumer([&](){
+    pinThread(consumercpu);
+    std::vector<float> data(chunk);
+    for(unsigned long i=0; i<nchunks; i++){
+      ringbuffer.pop(data.data(),chunk);
+      poptime[i]=benchclock::now();
+    }
+  });
+
+  producer.join();
+  consumer.join();
+  auto stop=benchclock::now();
+
+  std::vector<long long> latency(nchunks);
+  for(unsigned long i=0; i<nchunks; i++){
+    latency[i]=std::chrono::duration_cast<std::chrono::nanoseconds>(poptime[i]-pushtime[i]).count();
+  }
+  std::sort(latency.begin(),latency.end());
+
+  double seconds=std::chrono::duration<double>(stop-start).count();
+
+  if(!first) out << ",\n";
+  out << "    {\"size\": " << size
+      << ", \"chunk\": " << chunk
+      << ", \"pinning\": \"" << pinningName(pinning) << "\""
+      << ", \"blocking_nap_us\": " << nap
+      << ", \"items\": " << nchunks*chunk
+      << ", \"seconds\": " << seconds
+      << ", \"items_per_sec\": " << (double)(nchunks*chunk)/seconds
+      << ", \"latency_ns\": {"
+      << "\"p50\": " << percentile(latency,0.5)
+      << ", \"p90\": " << percentile(latency,0.9)
+      << ", \"p99\": " << percentile(latency,0.99)
+      << ", \"p999\": " << percentile(latency,0.999)
+      << ", \"max\": " << latency.back()
+      << "}}";
+} // runConfig()
+
+
+/*
+ * Many small blocks per batch, as from one block per voice: push() and
+ *  pop() per block against one pushv() and popv() per batch, producer
+ *  and consumer on different cores
+ */
+static void runBatched(std::ostream &out,unsigned long blocks,unsigned long blocksize,
+                       bool vectored,bool first)
+{
+RingBuffer ringbuffer(65536,"batched");
+unsigned long nbatches=TOTALITEMS/(blocks*blocksize);
+int ncpus=(int)sysconf(_SC_NPROCESSORS_ONLN);
+
+  ringbuffer.pushMayBlock(true);
+  ringbuffer.popMayBlock(true);
+  ringbuffer.setBlockingNap(0);
+
+  auto start=benchclock::now();
+
+  std::thread producer([&](){
+    pinThread(0);
+    std::vector<float> data(blocks*blocksize,0.5);
+    std::vector<RingSpan> spans(blocks);
+    for(unsigned long i=0; i<blocks; i++) spans[i]={data.data()+i*blocksize,blocksize};
+    for(unsigned long batch=0; batch<nbatches; batch++){
+      if(vectored) ringbuffer.pushv(spans.data(),blocks);
+      else for(unsigned long i=0; i<blocks; i++) ringbuffer.push(spans[i].data,blocksize);
+    }
+  });
+
+  std::thread consumer([&](){
+    pinThread(ncpus>1 ? 1 : 0);
+    std::vector<float> data(blocks*blocksize);
+    std::vector<RingSpan> spans(blocks);
+    for(unsigned long i=0; i<blocks; i++) spans[i]={data.data()+i*blocksize,blocksize};
+    for(unsigned long batch=0; batch<nbatches; batch++){
+      if(vectored) ringbuffer.popv(spans.data(),blocks);
+      else for(unsigned long i=0; i<blocks; i++) ringbuffer.pop(spans[i].data,blocksize);
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  double seconds=std::chrono::duration<double>(benchclock::now()-start).count();
+
+  if(!first) out << ",\n";
+  out << "    {\"blocks\": " << blocks
+      << ", \"block_size\": " << blocksize
+      << ", \"vectored\": " << (vectored ? "true" : "false")
+      << ", \"items\": " << nbatches*blocks*blocksize
+      << ", \"seconds\": " << seconds
+      << ", \"items_per_sec\": " << (double)(nbatches*blocks*blocksize)/seconds
+      << "}";
+} // runBatched()
+
+
+int main(int argc,char **argv)
+{
+unsigned long sizes[]={1024,8192,65536,1048576};
+unsigned long chunks[]={64,256,1024};
+unsigned long naps[]={0,500};
+Pinning pinnings[]={PIN_NONE,PIN_SAME_CORE,PIN_SPLIT_CORES};
+std::ofstream outfile;
+bool first=true;
+
+  if(argc > 1) outfile.open(argv[1]);
+  std::ostream &out = (argc > 1) ? outfile : std::cout;
+
+  out << "{\n  \"benchmark\": \"ringbuffer\",\n";
+  out << "  \"cpus\": " << sysconf(_SC_NPROCESSORS_ONLN) << ",\n";
+  out << "  \"results\": [\n";
+
+  for(unsigned long size : sizes){
+    for(unsigned long chunk : chunks){
+      // a chunk must fit with room to spare, see the note in ringbuffer.cpp
+      if(chunk*2 > size) continue;
+      for(Pinning pinning : pinnings){
+        for(unsigned long nap : naps){
+          runConfig(out,size,chunk,pinning,nap,first);
+          first=false;
+        }
+      }
+    }
+  }
+
+  out << "\n  ],\n  \"batched\": [\n";
+
+  first=true;
+  for(unsigned long blocks : {4UL,16UL,64UL}){
+    for(unsigned long blocksize : {16UL,64UL}){
+      for(bool vectored : {false,true}){
+        runBatched(out,blocks,blocksize,vectored,first);
+        first=false;
+      }
+    }
+  }
+
+  out << "\n  ]\n}\n";
+
+  return 0;
+} // main()
@@ -86,6 +86,50 @@ float anadata[8];
   else std::cout << "Not enough data" << std::endl;
 
   std::cout << std::endl;
-  return 0;
+
+  // scatter-gather: three blocks in, two blocks out, across the wrap
+  RingBuffer vbuffer(10,"Vector");
+  float first[2]={1,2},second[3]={3,4,5},third[1]={6};
+  float outa[4],outb[2];
+  RingSpan inspans[3]={{first,2},{second,3},{third,1}};
+  RingSpan outspans[2]={{outa,4},{outb,2}};
+  int errors=0;
+  vbuffer.push(inputdata,7);
+  vbuffer.pop(anadata,7);
+  std::cout << "pushv: " << vbuffer.pushv(inspans,3) << std::endl;
+  std::cout << "popv: " << vbuffer.popv(outspans,2) << std::endl;
+  for(int i=0; i<4; i++) if(outa[i] != i+1) errors++;
+  for(int i=0; i<2; i++) if(outb[i] != i+5) errors++;
+
+  // all or nothing, unless partial
+  std::cout << "pushv 6+6: " << vbuffer.pushv(inspans,3) << " ";
+  std::cout << vbuffer.pushv(inspans,3) << " ";
+  std::cout << vbuffer.pushv(inspans,3,true) << std::endl;
+  if(vbuffer.items_available_for_read() != 9) errors++;
+  std::cout << "popv partial: " << vbuffer.popv(outspans,2,true) << " ";
+  outa[3]=0;
+  std::cout << vbuffer.popv(outspans,2,true) << std::endl;
+  if(outa[0] != 1 || outa[1] != 2 || outa[2] != 3 || outa[3] != 0) errors++;
+
+  // peek leaves the data in place, advance skips it, across the wrap
+  RingBuffer pbuffer(10,"Peek");
+  float peekdata[6];
+  pbuffer.push(inputdata,8);
+  pbuffer.pop(anadata,8);
+  pbuffer.push(inputdata,6); // 1..6, wrapping after 2
+  std::cout << "peek: " << pbuffer.peek(peekdata,5) << " ";
+  for(int i=0; i<5; i++) if(peekdata[i] != i+1) errors++;
+  if(pbuffer.items_available_for_read() != 6) errors++;
+  std::cout << "advance: " << pbuffer.advance(3) << " ";
+  std::cout << pbuffer.peek(peekdata,3) << " ";
+  for(int i=0; i<3; i++) if(peekdata[i] != i+4) errors++;
+  // more than there is: nothing happens
+  std::cout << pbuffer.peek(peekdata,4) << " " << pbuffer.advance(4) << std::endl;
+  if(pbuffer.items_available_for_read() != 3) errors++;
+  pbuffer.pop(anadata,3);
+  if(anadata[0] != 4 || anadata[2] != 6) errors++;
+
+  std::cout << (errors ? "Wrong data" : "Data ok") << std::endl;
+  return errors ? 1 : 0;
 }
 
@@ -0,0 +1,119 @@
+/**********************************************************************
+*          Copyright (c) 2026, Hogeschool voor de Kunsten Utrecht
+*                      Hilversum, the Netherlands
+*                          All rights reserved
+***********************************************************************
+*  This program is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with this program.
+*  If not, see <http://www.gnu.org/licenses/>.
+***********************************************************************
+*
+*  File name     : shm_test.cpp
+*  System name   : jack_module
+*
+*  Description   : shared memory ring buffer test
+*		   A child process produces a ramp into a ringbuffer
+*		    created by the parent, which checks what arrives
+*
+*
+*  Author        : Marc_G
+*  E-mail        : marc.groenewegen@hku.nl
+*
+**********************************************************************/
+
+
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "ringbuffer.h"
+
+#define CHUNKSIZE 64
+#define NCHUNKS 1000
+
+
+int main()
+{
+std::ostringstream shmname;
+float data[CHUNKSIZE];
+
+  shmname << "/shm_test_" << getpid();
+
+  RingBuffer *buffer=RingBuffer::createShared(shmname.str(),1024);
+  if(buffer == NULL) return 1;
+  buffer->popMayBlock(true);
+
+  pid_t child=fork();
+  if(child == 0){
+    // producer process
+    RingBuffer *producer=RingBuffer::attachShared(shmname.str());
+    if(producer == NULL) _exit(1);
+    producer->pushMayBlock(true);
+    for(unsigned long chunk=0; chunk<NCHUNKS; chunk++){
+      for(unsigned long i=0; i<CHUNKSIZE; i++) data[i]=chunk*CHUNKSIZE+i;
+      producer->push(data,CHUNKSIZE);
+    }
+    delete producer;
+    _exit(0);
+  }
+
+  // consumer process
+  unsigned long errors=0;
+  for(unsigned long chunk=0; chunk<NCHUNKS; chunk++){
+    buffer->pop(data,CHUNKSIZE);
+    for(unsigned long i=0; i<CHUNKSIZE; i++){
+      if(data[i] != chunk*CHUNKSIZE+i) errors++;
+    }
+  }
+
+  int status;
+  waitpid(child,&status,0);
+  std::cout << "Peers: " << buffer->getPeers() << std::endl;
+  std::cout << "Received " << NCHUNKS*CHUNKSIZE << " items, " << errors << " errors" << std::endl;
+
+  // the name is taken as long as we're alive
+  if(RingBuffer::createShared(shmname.str(),1024) != NULL) errors++;
+  delete buffer;
+
+  // a segment left behind by a process that crashed is replaced
+  child=fork();
+  if(child == 0){
+    RingBuffer::createShared(shmname.str(),1024);
+    _exit(0); // without deleting it
+  }
+  waitpid(child,NULL,0);
+  buffer=RingBuffer::createShared(shmname.str(),1024);
+  if(buffer == NULL) errors++;
+  delete buffer;
+  std::cout << "Stale segment " << (buffer ? "replaced" : "not replaced") << std::endl;
+
+  // a segment that isn't a published ringbuffer may still be in use
+  int fd=shm_open(shmname.str().c_str(),O_CREAT|O_EXCL|O_RDWR,0600);
+  if(fd >= 0){
+    if(ftruncate(fd,16) != 0) errors++;
+    close(fd);
+    buffer=RingBuffer::createShared(shmname.str(),1024);
+    if(buffer != NULL) errors++;
+    delete buffer;
+    fd=shm_open(shmname.str().c_str(),O_RDONLY,0);
+    std::cout << "Foreign segment " << (fd >= 0 ? "kept" : "removed") << std::endl;
+    if(fd < 0) errors++;
+    else close(fd);
+    shm_unlink(shmname.str().c_str());
+  }
+  else errors++;
+
+  return (errors == 0 && WEXITSTATUS(status) == 0) ? 0 : 1;
+} // main()